@@ -0,0 +1,34 @@
+#include "Baselines.h"
+
+#include <range/v3/all.hpp>
+#include "Utils.h"
+
+
+namespace baseline {
+
+void recalculate_total(const std::vector<Food>& rows, std::array<float, 5>& total_values) {
+    ranges::fill(total_values, 0.0f);
+
+    for (const auto& row : rows) {
+        for (const auto& index : views::iota(0u, row.values.size())) {
+            total_values[index] += row.values[index];
+        }
+    }
+}
+
+void scale_total_row(std::vector<Food>& rows, std::array<float, 5>& total_values, float& value, const float prev_value) {
+    // clang-format off
+    auto row_values = total_values
+        | views::filter([&](const auto& other_value) { return &value != &other_value; });
+
+    auto table_values = rows
+        | views::transform([](Food& food) -> auto& { return food.values; })
+        | views::join;
+    // clang-format on
+
+    for (auto&& other_value : views::concat(table_values, row_values)) {
+        other_value *= value / prev_value;
+    }
+}
+
+} // namespace baseline
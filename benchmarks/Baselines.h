@@ -0,0 +1,19 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "Food.h"
+
+
+// The meal code that the columnar `MealTable` and its kernels replaced, kept as it was so that the benchmarks can
+// compare against it. It lives in its own file, since it is the only part of the benchmarks that uses range-v3.
+namespace baseline {
+
+// `EditMealWidget::recalculate_total`: every value of every row added to the total row, one row at a time
+void recalculate_total(const std::vector<Food>& rows, std::array<float, 5>& total_values);
+
+// `EditMealWidget::draw_total_row` after a drag changed `value`, one of `total_values`, from `prev_value`: every other
+// value of the table and of the total row gets scaled by the same ratio, through a `views::concat` of the joined rows
+// and the rest of the total row
+void scale_total_row(std::vector<Food>& rows, std::array<float, 5>& total_values, float& value, float prev_value);
+
+} // namespace baseline
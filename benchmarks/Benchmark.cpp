@@ -0,0 +1,184 @@
+#include "Benchmark.h"
+
+#include <ctime>
+#include <algorithm>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include <nlohmann/json.hpp>
+#include "AtomicFile.h"
+#include "NutrientKernels.h"
+
+
+namespace bench {
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+double run_once(const Timed& timed, const size_t iterations) {
+    const auto start = clock::now();
+    timed(iterations);
+    return std::chrono::duration<double, std::nano>{ clock::now() - start }.count();
+}
+
+// Doubles the iteration count until a run takes long enough to be timed reliably
+size_t calibrate(const Timed& timed, const std::chrono::milliseconds min_time) {
+    const auto min_ns = std::chrono::duration<double, std::nano>{ min_time }.count();
+
+    auto iterations = size_t{ 1 };
+    while (true) {
+        const auto elapsed = run_once(timed, iterations);
+        if (elapsed >= min_ns) {
+            return iterations;
+        }
+
+        // Aims straight for the minimum time once the run is long enough to extrapolate from
+        const auto scale    = min_ns / elapsed * 1.2;
+        const auto estimate = elapsed > min_ns / 100.0 ? static_cast<size_t>(scale * static_cast<double>(iterations)) : 0;
+        iterations          = std::max(iterations * 2, estimate);
+    }
+}
+
+std::string format_time(const double ns) {
+    if (ns < 1'000.0) {
+        return fmt::format("{:.1f} ns", ns);
+    }
+    if (ns < 1'000'000.0) {
+        return fmt::format("{:.2f} us", ns / 1'000.0);
+    }
+    if (ns < 1'000'000'000.0) {
+        return fmt::format("{:.2f} ms", ns / 1'000'000.0);
+    }
+    return fmt::format("{:.2f} s", ns / 1'000'000'000.0);
+}
+
+nlohmann::json context_json() {
+    const auto now = std::time(nullptr);
+    auto date      = std::array<char, 32>{};
+    std::strftime(date.data(), date.size(), "%Y-%m-%dT%H:%M:%S", std::gmtime(&now));
+
+    return {
+        { "date", date.data() },
+        { "instruction_set", kernels::instruction_set() },
+#if defined(__clang__)
+        { "compiler", fmt::format("clang {}.{}", __clang_major__, __clang_minor__) },
+#elif defined(__GNUC__)
+        { "compiler", fmt::format("gcc {}.{}", __GNUC__, __GNUC_MINOR__) },
+#elif defined(_MSC_VER)
+        { "compiler", fmt::format("msvc {}", _MSC_VER) },
+#endif
+#ifdef NDEBUG
+        { "build_type", "release" },
+#else
+        { "build_type", "debug" },
+#endif
+    };
+}
+
+} // namespace
+
+
+void Suite::add(std::string name, Setup setup, const size_t items_per_op, const size_t iterations) {
+    m_entries.push_back(
+        { .name = std::move(name), .setup = std::move(setup), .items_per_op = items_per_op, .iterations = iterations });
+}
+
+void Suite::add_measurement(std::string name, std::string unit, Measure measure) {
+    m_measurements.push_back({ .name = std::move(name), .unit = std::move(unit), .measure = std::move(measure) });
+}
+
+bool Suite::run(const Options& options) {
+    auto results = std::vector<Result>{};
+
+    fmt::print("{:<44} {:>12} {:>12} {:>12} {:>16}\n", "Benchmark", "Iterations", "Median", "Min", "Items/s");
+    for (const auto& entry : m_entries) {
+        if (entry.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        const auto timed      = entry.setup();
+        const auto iterations = entry.iterations > 0 ? entry.iterations : calibrate(timed, options.min_time);
+
+        auto times = std::vector<double>{};
+        for (size_t repetition = 0; repetition < options.repetitions; ++repetition) {
+            times.push_back(run_once(timed, iterations) / static_cast<double>(iterations));
+        }
+        std::ranges::sort(times);
+
+        auto mean = 0.0;
+        for (const auto time : times) {
+            mean += time / static_cast<double>(times.size());
+        }
+
+        const auto& result = results.emplace_back(Result{
+            .name         = entry.name,
+            .iterations   = iterations,
+            .repetitions  = times.size(),
+            .median_ns    = times[times.size() / 2],
+            .min_ns       = times.front(),
+            .max_ns       = times.back(),
+            .mean_ns      = mean,
+            .items_per_op = entry.items_per_op,
+        });
+
+        const auto items_per_second = static_cast<double>(result.items_per_op) * 1e9 / result.median_ns;
+        fmt::print("{:<44} {:>12} {:>12} {:>12} {:>16.0f}\n", result.name, result.iterations,
+            format_time(result.median_ns), format_time(result.min_ns), items_per_second);
+    }
+
+    auto measurements = std::vector<Measurement>{};
+    for (const auto& entry : m_measurements) {
+        if (entry.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        if (measurements.empty()) {
+            fmt::print("\n{:<44} {:>16} {:>12}\n", "Measurement", "Value", "Unit");
+        }
+        const auto& measurement = measurements.emplace_back(
+            Measurement{ .name = entry.name, .value = entry.measure(), .unit = entry.unit });
+        fmt::print("{:<44} {:>16.0f} {:>12}\n", measurement.name, measurement.value, measurement.unit);
+    }
+
+    if (options.json_path.empty()) {
+        return true;
+    }
+
+    auto json_results = nlohmann::json::array();
+    for (const auto& result : results) {
+        json_results.push_back({
+            { "name", result.name },
+            { "iterations", result.iterations },
+            { "repetitions", result.repetitions },
+            { "median_ns", result.median_ns },
+            { "min_ns", result.min_ns },
+            { "max_ns", result.max_ns },
+            { "mean_ns", result.mean_ns },
+            { "items_per_op", result.items_per_op },
+        });
+    }
+
+    auto json_measurements = nlohmann::json::array();
+    for (const auto& measurement : measurements) {
+        json_measurements.push_back({
+            { "name", measurement.name },
+            { "value", measurement.value },
+            { "unit", measurement.unit },
+        });
+    }
+
+    const auto json_serial = nlohmann::json{
+        { "context", context_json() },
+        { "benchmarks", json_results },
+        { "measurements", json_measurements },
+    };
+    if (!atomic_write_file(options.json_path, json_serial.dump(4))) {
+        return false;
+    }
+
+    fmt::print("[INFO]: Wrote {} results and {} measurements to {}\n", results.size(), measurements.size(),
+        options.json_path);
+    return true;
+}
+
+} // namespace bench
@@ -0,0 +1,91 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <filesystem>
+#include <string_view>
+
+
+// Minimal benchmark harness. A benchmark is a setup function that prepares its inputs, untimed, and returns the code
+// to time. The timed code gets called with an iteration count and has to run the measured operation that many times.
+//
+// The iteration count is calibrated so that one run takes at least `min_time`, and every benchmark gets run
+// `repetitions` times. The median time per iteration is what gets compared between commits.
+//
+// Next to the timings, a suite takes measurements of whatever else is worth comparing between commits, like the size of
+// a file or the memory that a data structure takes.
+namespace bench {
+
+using Timed   = std::function<void(size_t iterations)>;
+using Setup   = std::function<Timed()>;
+using Measure = std::function<double()>;
+
+struct Options {
+    std::string filter;
+    std::filesystem::path json_path;
+    std::chrono::milliseconds min_time{ 100 };
+    size_t repetitions = 5;
+};
+
+struct Result {
+    std::string name;
+    size_t iterations   = 0;
+    size_t repetitions  = 0;
+    double median_ns    = 0.0;
+    double min_ns       = 0.0;
+    double max_ns       = 0.0;
+    double mean_ns      = 0.0;
+    size_t items_per_op = 1; // Processed items per iteration, for the throughput
+};
+
+struct Measurement {
+    std::string name;
+    double value = 0.0;
+    std::string unit;
+};
+
+class Suite {
+public:
+    // `items_per_op` is how many items (foods, rows, ...) a single iteration processes. A non-zero `iterations` skips
+    // the calibration, for operations too slow or too noisy to be repeated until `min_time`.
+    void add(std::string name, Setup setup, size_t items_per_op = 1, size_t iterations = 0);
+
+    // `measure` gets called once, when the measurement runs, and returns its value in `unit`
+    void add_measurement(std::string name, std::string unit, Measure measure);
+
+    // Runs every benchmark and takes every measurement whose name contains `options.filter`, prints tables of the
+    // results and writes them as json when `options.json_path` is set. Returns false when the results couldn't be
+    // written.
+    bool run(const Options& options);
+
+private:
+    struct Entry {
+        std::string name;
+        Setup setup;
+        size_t items_per_op = 1;
+        size_t iterations   = 0;
+    };
+
+    struct MeasurementEntry {
+        std::string name;
+        std::string unit;
+        Measure measure;
+    };
+
+    std::vector<Entry> m_entries;
+    std::vector<MeasurementEntry> m_measurements;
+};
+
+// Keeps the compiler from optimizing away a computation whose result is otherwise unused
+template <typename T>
+void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static_cast<void>(*static_cast<const volatile char*>(static_cast<const volatile void*>(&value)));
+#endif
+}
+
+} // namespace bench
@@ -0,0 +1,556 @@
+#include <map>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <span>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <charconv>
+#include <algorithm>
+#include <unordered_map>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <nlohmann/json.hpp>
+#include "Meal.h"
+#include "MealTable.h"
+#include "MealDocument.h"
+#include "MealPlanner.h"
+#include "MemoryStats.h"
+#include "FoodCatalog.h"
+#include "FuzzySearch.h"
+#include "Baselines.h"
+#include "Benchmark.h"
+#include "Generators.h"
+
+using namespace std::literals;
+
+
+namespace {
+
+constexpr auto food_counts  = std::array<size_t, 4>{ 1'000, 10'000, 100'000, 1'000'000 };
+constexpr auto row_counts   = std::array<size_t, 4>{ 16, 256, 4'096, 65'536 };
+constexpr auto food_choices = std::array<size_t, 5>{ 4, 16, 64, 256, 1'024 };
+constexpr auto history_days = size_t{ 3'653 }; // Ten years
+
+// Generating a million names takes a while, so every data set is generated once and only when a benchmark needs it
+class DataSets {
+public:
+    const std::vector<std::string>& names(const size_t count) {
+        auto& names = m_names[count];
+        if (names == nullptr) {
+            names = std::make_shared<const std::vector<std::string>>(generate::food_names(count));
+        }
+        return *names;
+    }
+
+    const FoodCatalog& catalog(const size_t count) {
+        auto& catalog = m_catalogs[count];
+        if (catalog == nullptr) {
+            catalog = std::make_shared<const FoodCatalog>(generate::catalog(names(count)));
+        }
+        return *catalog;
+    }
+
+    // Ten years of meals, of foods of the catalog of 10'000
+    const MealDocument& history() {
+        if (m_history == nullptr) {
+            m_history = std::make_shared<const MealDocument>(generate::history(catalog(10'000), history_days));
+        }
+        return *m_history;
+    }
+
+private:
+    std::map<size_t, std::shared_ptr<const std::vector<std::string>>> m_names;
+    std::map<size_t, std::shared_ptr<const FoodCatalog>> m_catalogs;
+    std::shared_ptr<const MealDocument> m_history;
+};
+
+// Keeps a running total of the bytes that a container has allocated through it and its copies
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    explicit CountingAllocator(size_t& counter) noexcept
+        : allocated_bytes(&counter) {}
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : allocated_bytes(other.allocated_bytes) {}
+
+    T* allocate(const size_t count) {
+        *allocated_bytes += count * sizeof(T);
+        return std::allocator<T>{}.allocate(count);
+    }
+
+    void deallocate(T* pointer, const size_t count) noexcept {
+        *allocated_bytes -= count * sizeof(T);
+        std::allocator<T>{}.deallocate(pointer, count);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept {
+        return allocated_bytes == other.allocated_bytes;
+    }
+
+    size_t* allocated_bytes;
+};
+
+// Bytes that the characters of `string` take on the heap, none when they fit into the string itself
+size_t heap_bytes(const std::string& string) {
+    const auto* object   = reinterpret_cast<const char*>(&string);
+    const auto is_inline = string.data() >= object && string.data() < object + sizeof(string);
+    return is_inline ? 0 : string.capacity() + 1;
+}
+
+std::vector<std::string_view> views_of(const std::vector<std::string>& strings) {
+    return { strings.begin(), strings.end() };
+}
+
+void add_catalog_benchmarks(bench::Suite& suite, DataSets& data, const size_t food_count,
+    const std::filesystem::path& directory) {
+    const auto json_path   = directory / fmt::format("database_{}.json", food_count);
+    const auto binary_path = directory / fmt::format("database_{}.bin", food_count);
+
+    // Loading prints its timings, so it only gets run a fixed number of times rather than calibrated
+    suite.add(
+        fmt::format("catalog/load_json/{}", food_count),
+        [&data, food_count, json_path] {
+            std::ofstream{ json_path, std::ios::binary } << generate::database_json(data.names(food_count));
+            return [json_path](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    bench::do_not_optimize(FoodCatalog::load_json(json_path));
+                }
+            };
+        },
+        food_count, 1);
+
+    suite.add(
+        fmt::format("catalog/load_binary/{}", food_count),
+        [&data, food_count, binary_path] {
+            data.catalog(food_count).write_binary(binary_path, {});
+            return [binary_path](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    bench::do_not_optimize(FoodCatalog::load_binary(binary_path, std::nullopt));
+                }
+            };
+        },
+        food_count);
+
+    suite.add(
+        fmt::format("catalog/build/{}", food_count),
+        [&data, food_count] {
+            return [&names = data.names(food_count)](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    bench::do_not_optimize(generate::catalog(names));
+                }
+            };
+        },
+        food_count);
+}
+
+// Looking foods up by name, in the catalog's perfect hash and in the `std::unordered_map` it replaced
+void add_lookup_benchmarks(bench::Suite& suite, DataSets& data, const size_t food_count) {
+    constexpr auto key_count = size_t{ 4'096 };
+    const auto sample_keys   = [&data, food_count] {
+        auto random = generate::Random{ 5 };
+        auto keys   = std::vector<std::string>{};
+        for (size_t index = 0; index < key_count; ++index) {
+            keys.push_back(data.names(food_count)[random.below(food_count)]);
+        }
+        return keys;
+    };
+
+    suite.add(fmt::format("lookup/perfect_hash/{}", food_count), [&data, food_count, sample_keys] {
+        return [&catalog = data.catalog(food_count), keys = sample_keys()](const size_t iterations) {
+            // Lookups must not allocate, `NT_ASSERT_ALLOCATIONS=1 benchmarks` fails on the first that does
+            const auto limit = memory::AllocationLimit{ "lookup/perfect_hash", 0 };
+            for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                bench::do_not_optimize(catalog.find_id(keys[iteration % key_count]));
+            }
+        };
+    });
+
+    suite.add(fmt::format("lookup/unordered_map/{}", food_count), [&data, food_count, sample_keys] {
+        auto map = std::unordered_map<std::string, FoodId>{};
+        map.reserve(food_count);
+        for (const auto& name : data.names(food_count)) {
+            map.emplace(name, FoodCatalog::id_at(map.size()));
+        }
+
+        return [map = std::move(map), keys = sample_keys()](const size_t iterations) {
+            for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                bench::do_not_optimize(map.find(keys[iteration % key_count]));
+            }
+        };
+    });
+
+    // The whole catalog image, which holds the values of every food next to the names and the hash, against only the
+    // nodes, buckets and name strings of a map built like the one above
+    suite.add_measurement(fmt::format("lookup/footprint_perfect_hash/{}", food_count), "bytes", [&data, food_count] {
+        return static_cast<double>(data.catalog(food_count).image_size());
+    });
+
+    suite.add_measurement(fmt::format("lookup/footprint_unordered_map/{}", food_count), "bytes", [&data, food_count] {
+        using Allocator = CountingAllocator<std::pair<const std::string, FoodId>>;
+        using Map       = std::unordered_map<std::string, FoodId, std::hash<std::string>, std::equal_to<>, Allocator>;
+
+        auto allocated_bytes = size_t{ 0 };
+        auto map             = Map{ Allocator{ allocated_bytes } };
+        map.reserve(food_count);
+        for (const auto& name : data.names(food_count)) {
+            map.emplace(name, FoodCatalog::id_at(map.size()));
+        }
+
+        auto string_bytes = size_t{ 0 };
+        for (const auto& [name, id] : map) {
+            string_bytes += heap_bytes(name);
+        }
+        return static_cast<double>(allocated_bytes + string_bytes);
+    });
+}
+
+void add_search_benchmarks(bench::Suite& suite, DataSets& data, const size_t food_count) {
+    suite.add(
+        fmt::format("search/build_index/{}", food_count),
+        [&data, food_count] {
+            return [items = views_of(data.names(food_count))](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    bench::do_not_optimize(FuzzySearchIndex{ items });
+                }
+            };
+        },
+        food_count);
+
+    // A ranked search for the best 256 matches, like the dropdown makes
+    suite.add(fmt::format("search/query/{}", food_count), [&data, food_count] {
+        const auto& names = data.names(food_count);
+        auto index        = std::make_shared<const FuzzySearchIndex>(views_of(names));
+
+        return [index, queries = generate::queries(names, 256), matches = std::vector<FuzzySearchIndex::Match>{}](
+                   const size_t iterations) mutable {
+            for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                index->search(queries[iteration % queries.size()], matches, 256);
+                bench::do_not_optimize(matches.data());
+            }
+        };
+    });
+
+    // Typing a query one character at a time, every keystroke narrows down the matches of the previous one
+    suite.add(fmt::format("search/typing/{}", food_count), [&data, food_count] {
+        const auto& names = data.names(food_count);
+        auto index        = std::make_shared<const FuzzySearchIndex>(views_of(names));
+
+        return [index, queries = generate::queries(names, 256)](const size_t iterations) {
+            for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                const auto& query = queries[iteration % queries.size()];
+                auto cache        = FuzzySearchCache{};
+                for (size_t length = 1; length <= query.size(); ++length) {
+                    bench::do_not_optimize(cache.search(*index, std::string_view{ query }.substr(0, length), 256));
+                }
+            }
+        };
+    });
+}
+
+void add_meal_benchmarks(bench::Suite& suite, DataSets& data, const size_t row_count) {
+    const auto make_table = [&data, row_count] {
+        auto table = MealTable{};
+        for (const auto& row : generate::meal(data.catalog(10'000), row_count).rows) {
+            table.push_back(row);
+        }
+        return table;
+    };
+
+    suite.add(
+        fmt::format("totals/recompute/{}", row_count),
+        [make_table] {
+            return [table = make_table()](const size_t iterations) mutable {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    table.recompute_totals();
+                    bench::do_not_optimize(table.totals());
+                }
+            };
+        },
+        row_count);
+
+    // The row by row summing of the meal that the columnar table replaced
+    suite.add(
+        fmt::format("totals/ranges_baseline/{}", row_count),
+        [&data, row_count] {
+            return [rows = generate::meal(data.catalog(10'000), row_count).rows](const size_t iterations) {
+                auto total_values = std::array<float, 5>{};
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    baseline::recalculate_total(rows, total_values);
+                    bench::do_not_optimize(total_values);
+                }
+            };
+        },
+        row_count);
+
+    // Editing one row, which updates the totals incrementally
+    suite.add(fmt::format("totals/set_row/{}", row_count), [make_table, row_count] {
+        return [table = make_table(), row_count](const size_t iterations) mutable {
+            const auto limit = memory::AllocationLimit{ "totals/set_row", 0 };
+            for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                auto row = table.row(iteration % row_count);
+                row.values[Food::Weight] += 1.0f;
+                table.set_row(iteration % row_count, row);
+                bench::do_not_optimize(table.totals());
+            }
+        };
+    });
+
+    // Dragging a value of the total row: every frame of the drag rescales the whole table
+    suite.add(
+        fmt::format("scale/total_row/{}", row_count),
+        [make_table] {
+            return [table = make_table()](const size_t iterations) mutable {
+                table.begin_scale();
+                const auto total = table.totals()[Food::Calories];
+                const auto limit = memory::AllocationLimit{ "scale/total_row", 0 };
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    table.scale_total(Food::Calories, total * (1.0 + static_cast<double>(iteration % 16) / 16.0));
+                    bench::do_not_optimize(table.totals());
+                }
+                bench::do_not_optimize(table.end_scale());
+            };
+        },
+        row_count);
+
+    // The same drag through the ranges pipeline that the kernels replaced
+    suite.add(
+        fmt::format("scale/ranges_baseline/{}", row_count),
+        [&data, row_count] {
+            return [rows = generate::meal(data.catalog(10'000), row_count).rows](const size_t iterations) mutable {
+                auto total_values = std::array<float, 5>{};
+                baseline::recalculate_total(rows, total_values);
+
+                auto& value      = total_values[Food::Calories];
+                const auto total = value;
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    const auto prev_value = value;
+                    value                 = total * (1.0f + static_cast<float>(iteration % 16) / 16.0f);
+                    baseline::scale_total_row(rows, total_values, value, prev_value);
+                    bench::do_not_optimize(total_values);
+                }
+            };
+        },
+        row_count);
+
+    // `EditMealWidget::serialize` and `deserialize` are these plus copying the table to and from the snapshot
+    suite.add(
+        fmt::format("serialize/to_json/{}", row_count),
+        [&data, row_count] {
+            const auto& catalog = data.catalog(10'000);
+            return [&catalog, meal = generate::meal(catalog, row_count)](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    bench::do_not_optimize(meal.to_json(catalog).dump());
+                }
+            };
+        },
+        row_count);
+
+    suite.add(
+        fmt::format("serialize/from_json/{}", row_count),
+        [&data, row_count] {
+            const auto& catalog = data.catalog(10'000);
+            return [&catalog, text = generate::meal(catalog, row_count).to_json(catalog).dump()](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    auto table = MealTable{};
+                    for (const auto& row : MealSnapshot::from_json(nlohmann::json::parse(text), catalog).rows) {
+                        table.push_back(row);
+                    }
+                    table.recompute_totals();
+                    bench::do_not_optimize(table.totals());
+                }
+            };
+        },
+        row_count);
+}
+
+// The planner's candidates are the foods of a meal, and its targets a variation of the meal's own totals that it can
+// reach by changing the weights
+void add_planner_benchmarks(bench::Suite& suite, DataSets& data, const size_t food_count) {
+    const auto make_problem = [&data, food_count] {
+        const auto& catalog = data.catalog(10'000);
+        const auto meal     = generate::meal(catalog, food_count);
+
+        auto candidates = std::vector<MealPlanner::Candidate>{};
+        auto totals     = MealPlanner::Targets{};
+        for (const auto& row : meal.rows) {
+            candidates.push_back({ .props = catalog.props(row.id), .weight = row.values[Food::Weight] });
+            for (size_t index = 0; index < totals.size(); ++index) {
+                totals[index] += static_cast<double>(row.values[index]);
+            }
+        }
+
+        const auto protein = totals[Food::Protein] * 1.2;
+        const auto carbo   = totals[Food::Carbo] * 0.8;
+        const auto fat     = totals[Food::Fat];
+        return std::pair{ candidates, MealPlanner::Targets{ protein, carbo, fat, 4.0 * protein + 4.0 * carbo + 9.0 * fat } };
+    };
+
+    // The first solve after the foods change
+    suite.add(
+        fmt::format("planner/solve_cold/{}", food_count),
+        [make_problem] {
+            return [problem = make_problem()](const size_t iterations) {
+                const auto& [candidates, targets] = problem;
+                auto planner                      = MealPlanner{};
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    planner.set_candidates(candidates);
+                    bench::do_not_optimize(planner.solve(targets));
+                }
+            };
+        },
+        food_count);
+
+    // Dragging a target: every frame moves it a little and solves again, starting from the last frame's solution
+    suite.add(
+        fmt::format("planner/solve_warm/{}", food_count),
+        [make_problem] {
+            return [problem = make_problem()](const size_t iterations) {
+                const auto& [candidates, targets] = problem;
+                auto planner                      = MealPlanner{ candidates };
+                planner.solve(targets);
+
+                auto dragged     = targets;
+                const auto limit = memory::AllocationLimit{ "planner/solve_warm", 0 };
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    const auto frame       = static_cast<double>(iteration % 64);
+                    dragged[Food::Protein] = targets[Food::Protein] * (1.0 + 0.002 * std::min(frame, 64.0 - frame));
+                    bench::do_not_optimize(planner.solve(dragged));
+                }
+            };
+        },
+        food_count);
+}
+
+// A whole history saved as a single document and loaded back, in the binary format and as json. The throughput is in
+// days of meals per second.
+void add_document_benchmarks(bench::Suite& suite, DataSets& data) {
+    suite.add(
+        "document/encode_binary/10y",
+        [&data] {
+            return [&catalog = data.catalog(10'000), &history = data.history()](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    bench::do_not_optimize(history.encode(catalog));
+                }
+            };
+        },
+        history_days);
+
+    suite.add(
+        "document/decode_binary/10y",
+        [&data] {
+            const auto& catalog = data.catalog(10'000);
+            return [&catalog, bytes = data.history().encode(catalog)](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    bench::do_not_optimize(MealDocument::decode(bytes, catalog));
+                }
+            };
+        },
+        history_days);
+
+    suite.add(
+        "document/encode_json/10y",
+        [&data] {
+            return [&catalog = data.catalog(10'000), &history = data.history()](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    bench::do_not_optimize(history.to_json(catalog).dump());
+                }
+            };
+        },
+        history_days);
+
+    suite.add(
+        "document/decode_json/10y",
+        [&data] {
+            const auto& catalog = data.catalog(10'000);
+            return [&catalog, text = data.history().to_json(catalog).dump()](const size_t iterations) {
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    bench::do_not_optimize(MealDocument::from_json(nlohmann::json::parse(text), catalog));
+                }
+            };
+        },
+        history_days);
+
+    suite.add_measurement("document/size_binary/10y", "bytes", [&data] {
+        return static_cast<double>(data.history().encode(data.catalog(10'000)).size());
+    });
+
+    suite.add_measurement("document/size_json/10y", "bytes", [&data] {
+        return static_cast<double>(data.history().to_json(data.catalog(10'000)).dump().size());
+    });
+}
+
+void print_usage() {
+    fmt::print("Usage: benchmarks [--filter <substring>] [--json <path>] [--max-foods <count>] [--min-time-ms <ms>]\n"
+               "                  [--repetitions <count>]\n");
+}
+
+// Returns 0 when `text` isn't a number
+size_t parse_count(const std::string_view text) {
+    auto value              = size_t{ 0 };
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size() ? value : 0;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[]) {
+    auto options   = bench::Options{};
+    auto max_foods = food_counts.back();
+
+    const auto args = std::span{ argv, static_cast<size_t>(argc) }.subspan(1);
+    // Every option takes a value, and the numeric ones have to be positive
+    for (size_t index = 0; index < args.size(); index += 2) {
+        const auto arg   = std::string_view{ args[index] };
+        const auto value = index + 1 < args.size() ? std::string_view{ args[index + 1] } : std::string_view{};
+        const auto count = parse_count(value);
+
+        if (arg == "--filter" && !value.empty()) {
+            options.filter = value;
+        } else if (arg == "--json" && !value.empty()) {
+            options.json_path = value;
+        } else if (arg == "--max-foods" && count > 0) {
+            max_foods = count;
+        } else if (arg == "--min-time-ms" && count > 0) {
+            options.min_time = std::chrono::milliseconds{ count };
+        } else if (arg == "--repetitions" && count > 0) {
+            options.repetitions = count;
+        } else {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto directory = std::filesystem::temp_directory_path() / "nutrition-tracker-benchmarks";
+    std::filesystem::create_directories(directory);
+
+    auto data  = DataSets{};
+    auto suite = bench::Suite{};
+    for (const auto food_count : food_counts) {
+        if (food_count <= max_foods) {
+            add_catalog_benchmarks(suite, data, food_count, directory);
+            add_lookup_benchmarks(suite, data, food_count);
+            add_search_benchmarks(suite, data, food_count);
+        }
+    }
+    for (const auto row_count : row_counts) {
+        add_meal_benchmarks(suite, data, row_count);
+    }
+    for (const auto food_count : food_choices) {
+        add_planner_benchmarks(suite, data, food_count);
+    }
+    add_document_benchmarks(suite, data);
+
+    const auto succeeded = suite.run(options);
+
+    auto error = std::error_code{};
+    std::filesystem::remove_all(directory, error);
+    return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
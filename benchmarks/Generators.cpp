@@ -0,0 +1,192 @@
+#include "Generators.h"
+
+#include <array>
+#include <cmath>
+#include <chrono>
+#include <iterator>
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+#include <fmt/format.h>
+#include "FuzzySearch.h"
+#include "Fixtures.h"
+
+using namespace std::literals;
+
+
+namespace generate {
+namespace {
+
+constexpr auto base_foods = std::array{ "Orez"sv, "Ton"sv, "Pâine"sv, "Iaurt"sv, "Căpșuni"sv, "Brânză de vaci"sv,
+    "Piept de pui"sv, "Cartofi"sv, "Fasole"sv, "Linte"sv, "Mămăligă"sv, "Ouă"sv, "Lapte"sv, "Smântână"sv, "Roșii"sv,
+    "Castraveți"sv, "Ardei"sv, "Ceapă"sv, "Usturoi"sv, "Morcovi"sv, "Mere"sv, "Pere"sv, "Prune"sv, "Caise"sv,
+    "Cireșe"sv, "Nuci"sv, "Alune"sv, "Migdale"sv, "Ovăz"sv, "Paste"sv, "Somon"sv, "Păstrăv"sv, "Carne de vită"sv,
+    "Carne de porc"sv, "Curcan"sv, "Șuncă"sv, "Salam"sv, "Cașcaval"sv, "Telemea"sv, "Ciocolată"sv, "Miere"sv,
+    "Dovlecei"sv, "Vinete"sv, "Spanac"sv, "Varză"sv, "Conopidă"sv, "Broccoli"sv, "Ciuperci"sv };
+
+constexpr auto qualifiers = std::array{ "fiert"sv, "copt"sv, "prăjit"sv, "la grătar"sv, "integral"sv, "degresat"sv,
+    "bio"sv, "cu sare"sv, "fără zahăr"sv, "afumat"sv, "uscat"sv, "proaspăt"sv, "congelat"sv, "în suc propriu"sv,
+    "cu ulei"sv, "light"sv, "de casă"sv, "marinat"sv, "feliat"sv, "tocat"sv, "pasat"sv, "crud"sv, "înăbușit"sv,
+    "cu legume"sv, "cu smântână"sv, "picant"sv, "dulce"sv, "sărat"sv, "natural"sv, "extra"sv };
+
+constexpr auto brands = std::array{ "Napolact"sv, "Olympus"sv, "Covalact"sv, "Dorna"sv, "Fulga"sv, "Hochland"sv,
+    "Pilos"sv, "Carrefour"sv, "Kaufland"sv, "Lidl"sv, "Mega"sv, "Profi"sv, "Auchan"sv, "Penny"sv, "Boromir"sv,
+    "Vel Pitar"sv, "Agricola"sv, "Cris-Tim"sv, "Angst"sv, "Aldis"sv };
+
+} // namespace
+
+
+std::vector<std::string> food_names(const size_t count, const uint64_t seed) {
+    auto random = Random{ seed };
+    auto seen   = std::unordered_set<std::string>{};
+    auto names  = std::vector<std::string>{};
+    names.reserve(count);
+    seen.reserve(count);
+
+    while (names.size() < count) {
+        auto name = std::string{ base_foods[random.below(base_foods.size())] };
+
+        const auto qualifier_count = random.below(3);
+        for (size_t index = 0; index < qualifier_count; ++index) {
+            name += ' ';
+            name += qualifiers[random.below(qualifiers.size())];
+        }
+        if (random.below(2) == 0) {
+            name += ' ';
+            name += brands[random.below(brands.size())];
+        }
+
+        // Variants like package sizes tell apart what would otherwise be duplicates
+        if (seen.contains(name)) {
+            name += fmt::format(" {}g", 50 * (1 + random.below(40)));
+        }
+        if (seen.insert(name).second) {
+            names.push_back(std::move(name));
+        }
+    }
+    return names;
+}
+
+std::string database_json(const std::vector<std::string>& names, const uint64_t seed) {
+    auto random = Random{ seed };
+    auto out    = std::string{ "{\n" };
+
+    for (size_t index = 0; index < names.size(); ++index) {
+        const auto protein = random.between(0.0f, 0.4f);
+        const auto carbo   = random.between(0.0f, 0.8f);
+        const auto fat     = random.between(0.0f, 0.5f);
+        fmt::format_to(std::back_inserter(out),
+            "    \"{}\": {{\n        \"protein\": {:.3f},\n        \"carbo\": {:.3f},\n        \"fat\": {:.3f},\n"
+            "        \"calories\": {:.1f}\n    }}{}\n",
+            names[index], protein, carbo, fat, 4.0f * protein + 4.0f * carbo + 9.0f * fat,
+            index + 1 < names.size() ? "," : "");
+    }
+
+    out += "}\n";
+    return out;
+}
+
+FoodCatalog catalog(const std::vector<std::string>& names, const uint64_t seed) {
+    auto random  = Random{ seed };
+    auto builder = FoodCatalogBuilder{};
+    builder.reserve(names.size());
+
+    for (const auto& name : names) {
+        const auto protein = random.between(0.0f, 0.4f);
+        const auto carbo   = random.between(0.0f, 0.8f);
+        const auto fat     = random.between(0.0f, 0.5f);
+        builder.add(name, { .props = { protein, carbo, fat, 4.0f * protein + 4.0f * carbo + 9.0f * fat, 1.0f } });
+    }
+    return std::move(builder).build();
+}
+
+MealSnapshot meal(const FoodCatalog& food_catalog, const size_t row_count, const uint64_t seed) {
+    auto random = Random{ seed };
+    auto result = MealSnapshot{ .title = "Prânz", .notes = "Generated for the benchmarks" };
+    result.rows.reserve(row_count);
+
+    for (size_t index = 0; index < row_count; ++index) {
+        const auto id     = FoodCatalog::id_at(random.below(food_catalog.size()));
+        const auto weight = random.between(10.0f, 400.0f);
+        result.rows.push_back(fixtures::make_row(food_catalog, id, weight));
+    }
+    return result;
+}
+
+MealDocument history(const FoodCatalog& food_catalog, const size_t day_count, const uint64_t seed) {
+    constexpr auto titles = std::array{ "Mic dejun"sv, "Prânz"sv, "Cină"sv, "Gustare"sv, "Gustare"sv };
+    constexpr auto notes  = std::array{ "Prea sărat"sv, "La restaurant"sv, "Porție dublă"sv, "Rețeta bunicii"sv };
+
+    auto random = Random{ seed };
+    auto foods  = std::vector<FoodId>{};
+    for (size_t index = 0; index < std::min(food_catalog.size(), size_t{ 300 }); ++index) {
+        foods.push_back(FoodCatalog::id_at(random.below(food_catalog.size())));
+    }
+
+    const auto last_day = std::chrono::sys_days{ std::chrono::year{ 2024 } / 12 / 31 };
+    auto result         = MealDocument{};
+    result.meals.reserve(day_count * 4);
+
+    for (size_t day = day_count; day-- > 0;) {
+        const auto meal_count = 3 + random.below(3);
+        for (size_t index = 0; index < meal_count; ++index) {
+            auto meal = MealSnapshot{ .title = std::string{ titles[index] } };
+            if (random.below(10) == 0) {
+                meal.notes = notes[random.below(notes.size())];
+            }
+
+            const auto row_count = 2 + random.below(9);
+            for (size_t row_index = 0; row_index < row_count; ++row_index) {
+                const auto id     = foods[random.below(foods.size())];
+                const auto weight = std::round(random.between(10.0f, 400.0f));
+                meal.rows.push_back(fixtures::make_row(food_catalog, id, weight));
+            }
+
+            result.meals.push_back({
+                .day   = last_day - std::chrono::days{ static_cast<int>(day) },
+                .index = static_cast<uint32_t>(index),
+                .meal  = std::move(meal),
+            });
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> queries(const std::vector<std::string>& names, const size_t count, const uint64_t seed) {
+    auto random  = Random{ seed };
+    auto results = std::vector<std::string>{};
+    results.reserve(count);
+
+    // Prefixes of the words, cut at a character boundary
+    const auto prefix = [&](const std::string_view word) {
+        auto length = std::min(word.size(), size_t{ 2 } + random.below(5));
+        while (length < word.size() && (static_cast<unsigned char>(word[length]) & 0xC0) == 0x80) {
+            ++length;
+        }
+        return std::string{ word.substr(0, length) };
+    };
+
+    while (results.size() < count) {
+        const auto& name = names[random.below(names.size())];
+
+        auto words = std::vector<std::string_view>{};
+        for (size_t begin = 0; begin < name.size();) {
+            const auto end = std::min(name.find(' ', begin), name.size());
+            words.emplace_back(name.data() + begin, end - begin);
+            begin = end + 1;
+        }
+
+        auto query = prefix(words[random.below(words.size())]);
+        if (words.size() > 1 && random.below(3) == 0) {
+            query += ' ';
+            query += prefix(words[random.below(words.size())]);
+        }
+        if (random.below(2) == 0) {
+            query = fold_search_text(query);
+        }
+        results.push_back(std::move(query));
+    }
+    return results;
+}
+
+} // namespace generate
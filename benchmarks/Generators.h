@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Meal.h"
+#include "MealDocument.h"
+#include "FoodCatalog.h"
+
+
+// Deterministic synthetic data for the benchmarks, the same seed always generates the same data
+namespace generate {
+
+// Small and fast PRNG (splitmix64), good enough for test data
+class Random {
+public:
+    explicit Random(const uint64_t seed)
+        : m_state(seed) {}
+
+    uint64_t next() noexcept {
+        auto value = (m_state += 0x9E3779B97F4A7C15);
+        value      = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value      = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+
+    // In `[0, bound)`
+    size_t below(const size_t bound) noexcept {
+        return next() % bound;
+    }
+
+    // In `[low, high)`
+    float between(const float low, const float high) noexcept {
+        return low + static_cast<float>(next() >> 40) / static_cast<float>(uint64_t{ 1 } << 24) * (high - low);
+    }
+
+private:
+    uint64_t m_state;
+};
+
+// Unique names that look like the ones of the real database: a base food with diacritics, some qualifiers, and a brand
+// or a variant number once the plain combinations run out
+[[nodiscard]] std::vector<std::string> food_names(size_t count, uint64_t seed = 1);
+
+// The json database with `names` as its foods, in the format of `res/database.json`
+[[nodiscard]] std::string database_json(const std::vector<std::string>& names, uint64_t seed = 2);
+
+[[nodiscard]] FoodCatalog catalog(const std::vector<std::string>& names, uint64_t seed = 2);
+
+// A meal of `row_count` random foods of `food_catalog` with realistic weights
+[[nodiscard]] MealSnapshot meal(const FoodCatalog& food_catalog, size_t row_count, uint64_t seed = 3);
+
+// `day_count` days of meals ending on 2024-12-31, three to five a day, of foods drawn from a few hundred of the
+// catalog's like the ones someone eats regularly
+[[nodiscard]] MealDocument history(const FoodCatalog& food_catalog, size_t day_count, uint64_t seed = 5);
+
+// What users type into the food search: prefixes of words of the names, sometimes two words, sometimes without the
+// diacritics
+[[nodiscard]] std::vector<std::string> queries(const std::vector<std::string>& names, size_t count, uint64_t seed = 4);
+
+} // namespace generate
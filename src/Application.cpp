@@ -8,11 +8,35 @@
 #include <fmt/format.h>
 #include <fmt/color.h>
 #include <chrono>
+#include <ctime>
 #include <imgui_internal.h>
 #include <ratio>
+#include <span>
+#include <algorithm>
+#include <limits>
 
 #include "Application.h"
+#include "FontAtlasCache.h"
+#include "MemoryStats.h"
 #include "Utils.h"
+#include "Profiler.h"
+
+
+namespace {
+
+// ImGui needs a couple of frames to settle after input, like a hover that is only known a frame after the mouse moved
+constexpr auto frames_after_event = 3;
+
+// Out of focus, nothing gets rendered more often than this
+constexpr auto unfocused_frame_interval = std::chrono::milliseconds{ 250 };
+
+// Often enough to catch both the on and the off phase of ImGui's 1.2s caret blink
+constexpr auto caret_blink_interval = std::chrono::milliseconds{ 300 };
+
+// Taken during static initialization, which is as close to the launch of the process as it gets
+const auto launch_time = Application::clock::now();
+
+} // namespace
 
 
 Application::Application() {
@@ -54,6 +78,15 @@ Application::Application() {
 
     // Setting up Dear ImGui context
     IMGUI_CHECKVERSION();
+
+    // ImGui allocates with `malloc` rather than `operator new`, so it gets counted through its own allocator hooks. They
+    // have to be set before the context is created.
+    if constexpr (memory::is_enabled) {
+        ImGui::SetAllocatorFunctions([](const size_t size, void* /*user_data*/) {
+            return memory::allocate(size, memory::Tag::ImGui);
+        }, [](void* pointer, void* /*user_data*/) { memory::deallocate(pointer); });
+    }
+
     ImGui::CreateContext();
 
     auto& io = ImGui::GetIO();
@@ -61,24 +94,29 @@ Application::Application() {
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
 
-    const auto latin_ranges = std::array<ImWchar, 7>{ 0x0020, 0x007E, // Basic Latin range
-        0x00A1, 0x024F,                                               // Latin-1 Supplement range
-        0x0100, 0x0173,                                               // Latin Extended-A
+    // The atlas keeps pointing at the ranges after it is built
+    static constexpr auto latin_ranges = std::array<ImWchar, 7>{ 0x0020, 0x007E, // Basic Latin range
+        0x00A1, 0x024F,                                                         // Latin-1 Supplement range
+        0x0100, 0x0173,                                                         // Latin Extended-A
         // 0x0180, 0x024f, // Latin Extended-B
         0 };
 
-    const auto font = "res/CascadiaCode-Regular.otf"sv;
-    if (io.Fonts->AddFontFromFileTTF(font.data(), 20.0f, nullptr, latin_ranges.data()) == nullptr) {
-        fmt::print(fmt::fg(fmt::color::red), "[ERROR]: Font '{}' not found", font.data());
-    }
-
-    io.Fonts->Build();
+    // Falls back to ImGui's default font, built on the first frame, when the font is missing
+    const auto font = FontAtlasSpec{
+        .font_path    = "res/CascadiaCode-Regular.otf",
+        .size_pixels  = 20.0f,
+        .glyph_ranges = latin_ranges.data(),
+    };
+    build_font_atlas(*io.Fonts, font, "res/font_atlas.cache");
 
     ImGui::StyleColorsDark();
     ImGui::GetStyle().ScaleAllSizes(1.5f);
 
     ImGui_ImplSDL2_InitForOpenGL(m_window, m_context);
     ImGui_ImplOpenGL3_Init(glsl_version);
+
+    // Lets other threads wake the loop up. `SDL_RegisterEvents` returns -1 when it runs out of event types.
+    s_wake_event  = SDL_RegisterEvents(1);
     s_initialized = true;
 }
 
@@ -93,43 +131,201 @@ Application::~Application() {
     s_initialized = false;
 }
 
+void Application::request_frame(const clock::duration delay) {
+    if (delay <= clock::duration::zero()) {
+        s_pending_frames = std::max(s_pending_frames, 1);
+        return;
+    }
+
+    const auto time  = clock::now() + delay;
+    s_requested_time = s_requested_time.has_value() ? std::min(*s_requested_time, time) : time;
+}
+
+void Application::wake() {
+    if (s_wake_event == 0 || s_wake_event == static_cast<uint32_t>(-1)) {
+        return;
+    }
+
+    auto event = SDL_Event{};
+    event.type = s_wake_event;
+    SDL_PushEvent(&event);
+}
+
+FrameArena& Application::frame_arena() {
+    static auto arena = FrameArena{};
+    return arena;
+}
+
 void Application::run() {
-    auto then = std::chrono::high_resolution_clock::now();
-    auto& io  = ImGui::GetIO();
-
-    for (auto running = true; running;) {
-        for (auto event = SDL_Event{}; SDL_PollEvent(&event) != 0;) {
-            ImGui_ImplSDL2_ProcessEvent(&event);
-            // clang-format off
-            running = (event.type != SDL_QUIT && (
-                event.type != SDL_WINDOWEVENT ||
-                event.window.event != SDL_WINDOWEVENT_CLOSE ||
-                event.window.windowID != SDL_GetWindowID(m_window)
-            ));
-            //clang-format on
+    PROFILE_THREAD("UI");
+
+    const auto start_time     = clock::now();
+    const auto start_cpu_time = std::clock();
+    auto then                 = start_time;
+
+    request_frame();
+    while (wait_for_frame()) {
+        const auto now          = clock::now();
+        const auto elapsed_time = std::chrono::duration<double>{ now - then };
+        render_frame(elapsed_time.count());
+        then = now;
+    }
+
+    // `std::clock` is the CPU time of the whole process, except on Windows where it is the wall time
+    const auto run_time = std::chrono::duration<double>{ clock::now() - start_time }.count();
+    const auto cpu_time = static_cast<double>(std::clock() - start_cpu_time) / CLOCKS_PER_SEC;
+    const auto waited   = std::chrono::duration<double>{ m_wait_time }.count();
+    fmt::print("[INFO]: Rendered {} frames in {:.1f}s ({:.1f} per second), waited {:.0f}% of the time, used {:.2f}s of "
+               "CPU time\n",
+        m_frame_count, run_time, static_cast<double>(m_frame_count) / std::max(run_time, 1e-9),
+        100.0 * waited / std::max(run_time, 1e-9), cpu_time);
+}
+
+bool Application::wait_for_frame() {
+    PROFILE_FUNCTION();
+
+    const auto wait_start = clock::now();
+    auto running          = true;
+    auto event            = SDL_Event{};
+
+    // Sleeps until the next frame is due, or forever when none is. Events can make a frame due sooner.
+    while (running) {
+        const auto next_frame = next_frame_time();
+        if (next_frame.has_value() && clock::now() >= *next_frame) {
+            break;
+        }
+
+        auto has_event = 0;
+        if (next_frame.has_value()) {
+            const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(*next_frame - clock::now());
+            has_event          = SDL_WaitEventTimeout(&event, std::max(static_cast<int>(timeout.count()), 1));
+        } else {
+            has_event = SDL_WaitEvent(&event);
         }
 
-        // Begin new frame
+        if (has_event != 0) {
+            running = process_event(event);
+        }
+    }
+
+    // Whatever else arrived in the meantime gets handled by this frame as well
+    while (running && SDL_PollEvent(&event) != 0) {
+        running = process_event(event);
+    }
+
+    m_wait_time += clock::now() - wait_start;
+    return running;
+}
+
+bool Application::process_event(const SDL_Event& event) {
+    ImGui_ImplSDL2_ProcessEvent(&event);
+    s_pending_frames     = std::max(s_pending_frames, frames_after_event);
+    m_frames_since_event = 0;
+
+    if (event.type == SDL_WINDOWEVENT && event.window.windowID == SDL_GetWindowID(m_window)) {
+        switch (event.window.event) {
+        case SDL_WINDOWEVENT_MINIMIZED: m_is_minimized = true; break;
+        case SDL_WINDOWEVENT_RESTORED:
+        case SDL_WINDOWEVENT_MAXIMIZED:
+        case SDL_WINDOWEVENT_SHOWN: m_is_minimized = false; break;
+        case SDL_WINDOWEVENT_FOCUS_GAINED: m_is_focused = true; break;
+        case SDL_WINDOWEVENT_FOCUS_LOST: m_is_focused = false; break;
+        default: break;
+        }
+    }
+
+    // clang-format off
+    return (event.type != SDL_QUIT && (
+        event.type != SDL_WINDOWEVENT ||
+        event.window.event != SDL_WINDOWEVENT_CLOSE ||
+        event.window.windowID != SDL_GetWindowID(m_window)
+    ));
+    // clang-format on
+}
+
+std::optional<Application::clock::time_point> Application::next_frame_time() const noexcept {
+    if (m_is_minimized) {
+        return std::nullopt;
+    }
+    if (m_continuous_rendering) {
+        return m_last_frame_time;
+    }
+
+    const auto earliest = m_is_focused ? m_last_frame_time : m_last_frame_time + unfocused_frame_interval;
+    if (s_pending_frames > 0) {
+        return earliest;
+    }
+    if (s_requested_time.has_value()) {
+        return std::max(*s_requested_time, earliest);
+    }
+    return std::nullopt;
+}
+
+void Application::render_frame(const double dt) {
+    PROFILE_FUNCTION();
+
+    // Once the frames after an event have settled, a frame has nothing new to allocate for, the caret blinking or the
+    // app rendering continuously included. With allocation tracking, an idle frame that allocates anyway gets
+    // reported, and makes the app abort under `NT_ASSERT_ALLOCATIONS`.
+    const auto is_idle = m_frames_since_event > frames_after_event;
+    const auto limit   = memory::AllocationLimit{ "An idle frame", is_idle ? 0 : std::numeric_limits<uint64_t>::max() };
+
+    m_frames_since_event = std::min(m_frames_since_event + 1, frames_after_event + 1);
+
+    auto& io = ImGui::GetIO();
+
+    // Whatever asked for this frame got it, `on_update` can ask for more
+    m_last_frame_time = clock::now();
+    s_pending_frames  = std::max(s_pending_frames - 1, 0);
+    if (s_requested_time.has_value() && *s_requested_time <= m_last_frame_time) {
+        s_requested_time.reset();
+    }
+
+    // Begin new frame
+    {
+        PROFILE_ZONE("NewFrame");
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
+    }
 
-        const auto now          = std::chrono::high_resolution_clock::now();
-        const auto elapsed_time = std::chrono::duration<double>{ now - then };
-        on_update(elapsed_time.count());
-        then = now;
+    on_update(dt);
+
+    // Dragging and the like animate without any event coming in, and so does the caret of a text input
+    if (ImGui::IsAnyItemActive() && !io.WantTextInput) {
+        request_frame();
+    } else if (io.WantTextInput) {
+        request_frame(caret_blink_interval);
+    }
 
-        // End frame
+    // End frame
+    {
+        PROFILE_ZONE("Render");
         ImGui::Render();
         glViewport(0, 0, static_cast<GLint>(io.DisplaySize.x), static_cast<GLint>(io.DisplaySize.y));
         glClear(GL_COLOR_BUFFER_BIT);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        // ImGui copied whatever the widgets built in the arena into its draw lists
+        frame_arena().reset();
+    }
+    {
+        PROFILE_ZONE("SwapWindow");
         SDL_GL_SwapWindow(m_window);
     }
+
+    if (m_frame_count == 0) {
+        const auto time_to_first_frame = std::chrono::duration<double>{ clock::now() - launch_time };
+        fmt::print("[INFO]: Showed the first frame {:.1f}ms after launch\n", time_to_first_frame.count() * 1000.0);
+    }
+    ++m_frame_count;
 }
 
-int main(int /*argc*/, char* /*argv*/[]) {
+int main(int argc, char* argv[]) {
     if (auto app = create_application(); app->is_initialized()) {
+        // `--continuous` renders every vsync like before, to measure what idling saves
+        const auto args = std::span{ argv, static_cast<size_t>(argc) };
+        app->set_continuous_rendering(std::ranges::find(args, "--continuous"sv) != args.end());
         app->run();
         return EXIT_SUCCESS;
     }
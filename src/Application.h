@@ -1,10 +1,20 @@
 #pragma once
 #include <SDL_video.h>
+#include <chrono>
 #include <memory>
+#include <cstdint>
+#include <optional>
+#include "FrameArena.h"
 
 
+// Frames are only rendered when something might have changed: on input, for a few frames after it so that ImGui can
+// settle, and when a widget asked for a frame at some point in time (an animation, a blinking caret). In between, the
+// app sleeps in `SDL_WaitEventTimeout`. Frames get rendered much less often when the window is out of focus, and not
+// at all when it is minimized.
 class Application {
 public:
+    using clock = std::chrono::steady_clock;
+
     Application();
     virtual ~Application();
 
@@ -13,16 +23,53 @@ public:
         return s_initialized;
     }
 
+    // Renders a frame every vsync instead, to compare against
+    void set_continuous_rendering(const bool continuous) {
+        m_continuous_rendering = continuous;
+    }
+
+    // Asks for a frame to be rendered `delay` from now. Only to be called from the UI thread.
+    static void request_frame(clock::duration delay = {});
+
+    // Asks for a frame from any thread, for when something changed behind the UI's back
+    static void wake();
+
+    // Scratch memory of the frame being drawn, freed once it is rendered. Only to be used from the UI thread.
+    static FrameArena& frame_arena();
+
 protected:
     virtual void on_update(double dt) = 0;
     SDL_Window* get_window() const {
         return m_window;
     }
 
+private:
+    // Sleeps until there are events or a frame is due, returns whether the app should keep running
+    bool wait_for_frame();
+    bool process_event(const SDL_Event& event);
+    [[nodiscard]] std::optional<clock::time_point> next_frame_time() const noexcept;
+    void render_frame(double dt);
+
 private:
     SDL_Window* m_window             = nullptr;
     SDL_GLContext m_context          = nullptr;
     inline static bool s_initialized = false;
+
+    bool m_continuous_rendering = false;
+    bool m_is_minimized         = false;
+    bool m_is_focused           = true;
+    clock::time_point m_last_frame_time;
+
+    // Frames rendered since the last event, up to one more than the frames that an event gets to settle in
+    int m_frames_since_event = 0;
+
+    inline static uint32_t s_wake_event                             = 0;
+    inline static int s_pending_frames                              = 0;
+    inline static std::optional<clock::time_point> s_requested_time = std::nullopt;
+
+    // Idle cost, logged when the app exits
+    uint64_t m_frame_count = 0;
+    clock::duration m_wait_time{};
 };
 
 std::unique_ptr<Application> create_application();
@@ -0,0 +1,112 @@
+#include "AtomicFile.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include "Profiler.h"
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <windows.h>
+#else
+#    include <cerrno>
+#    include <cstring>
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+
+#ifdef _WIN32
+static bool write_and_sync(const std::filesystem::path& path, std::string_view contents) {
+    const auto file =
+        CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    while (!contents.empty()) {
+        auto written    = DWORD{ 0 };
+        const auto size = static_cast<DWORD>(std::min<size_t>(contents.size(), MAXDWORD));
+        if (WriteFile(file, contents.data(), size, &written, nullptr) == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        contents.remove_prefix(written);
+    }
+
+    const auto is_synced = FlushFileBuffers(file) != 0;
+    return (CloseHandle(file) != 0) && is_synced;
+}
+
+bool atomic_write_file(const std::filesystem::path& path, const std::string_view contents) {
+    PROFILE_FUNCTION();
+
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    if (!write_and_sync(temp_path, contents)) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Failed to write {}, error {}\n", temp_path, GetLastError());
+        DeleteFileW(temp_path.c_str());
+        return false;
+    }
+
+    if (MoveFileExW(temp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) == 0) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Failed to replace {}, error {}\n", path, GetLastError());
+        DeleteFileW(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+#else
+static bool write_and_sync(const std::filesystem::path& path, std::string_view contents) {
+    const auto fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return false;
+    }
+
+    while (!contents.empty()) {
+        const auto written = write(fd, contents.data(), contents.size());
+        if (written == -1 && errno == EINTR) {
+            continue;
+        }
+        if (written == -1) {
+            close(fd);
+            return false;
+        }
+        contents.remove_prefix(static_cast<size_t>(written));
+    }
+
+    const auto is_synced = fsync(fd) == 0;
+    return (close(fd) == 0) && is_synced;
+}
+
+bool atomic_write_file(const std::filesystem::path& path, const std::string_view contents) {
+    PROFILE_FUNCTION();
+
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    if (!write_and_sync(temp_path, contents)) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Failed to write {}: {}\n", temp_path, std::strerror(errno));
+        unlink(temp_path.c_str());
+        return false;
+    }
+
+    if (rename(temp_path.c_str(), path.c_str()) == -1) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Failed to replace {}: {}\n", path, std::strerror(errno));
+        unlink(temp_path.c_str());
+        return false;
+    }
+
+    // The rename itself only survives a crash once the directory holding the file is flushed too
+    const auto directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path{ "." };
+    const auto dir_fd    = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd != -1) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return true;
+}
+#endif
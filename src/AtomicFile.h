@@ -0,0 +1,9 @@
+#pragma once
+#include <string_view>
+#include <filesystem>
+
+
+// Replaces the contents of `path` with `contents` such that, even if the process or the machine crashes midway, the
+// file holds either its previous contents or the new ones in full. The contents are written to a temporary file next
+// to `path`, flushed to disk and then renamed over `path`.
+bool atomic_write_file(const std::filesystem::path& path, std::string_view contents);
@@ -0,0 +1,245 @@
+#include "AutoSaver.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include "MealDocument.h"
+#include "MemoryStats.h"
+#include "Profiler.h"
+
+
+// Past this many edits the journal gets folded into a new snapshot, which bounds both its size and the time it takes
+// to replay it on startup
+static constexpr size_t edits_per_compaction = 1024;
+
+RecoveredMeal AutoSaver::recover(const std::filesystem::path& snapshot_path, const std::filesystem::path& journal_path,
+    HistoryStore& history, const FoodCatalog& food_catalog) {
+    PROFILE_FUNCTION();
+
+    auto result = RecoveredMeal{ .key = { .day = today() } };
+
+    // Snapshots used to be saved as json, the last one of them gets picked up until the first binary one is written
+    auto path  = snapshot_path;
+    auto error = std::error_code{};
+    if (!std::filesystem::exists(path, error)) {
+        path.replace_extension(".json");
+    }
+
+    if (std::filesystem::exists(path, error)) {
+        if (auto snapshot = MealDocument::load(path, food_catalog); snapshot.has_value() && !snapshot->meals.empty()) {
+            auto& document_meal = snapshot->meals.front();
+            result.meal         = std::move(document_meal.meal);
+            result.sequence     = snapshot->journal_sequence;
+            result.key.meal     = document_meal.index;
+
+            // Snapshots from before the history existed have no day, they are taken to be today's
+            if (document_meal.day.has_value()) {
+                result.key.day = *document_meal.day;
+            }
+        }
+    }
+
+    // Recovers today's meal from the history when the snapshot and journal turn out to hold an earlier one
+    const auto start_today = [&] {
+        if (result.key.day == today()) {
+            return;
+        }
+
+        // Meals are stored into the history on every compaction, but the last edits might not have made it there
+        history.store_meal(result.key, result.meal, food_catalog);
+
+        result.key              = { .day = today() };
+        result.meal             = history.load_meal(result.key, food_catalog).value_or(MealSnapshot{});
+        result.needs_compaction = true;
+    };
+
+    const auto journal = MealJournal::read(journal_path, food_catalog);
+    if (!journal.has_value()) {
+        result.needs_compaction = true;
+        start_today();
+        return result;
+    }
+
+    // Records up to the snapshot's sequence are already part of it. They only remain when the app stopped between
+    // writing a snapshot and starting the new journal.
+    auto replayed_count = size_t{ 0 };
+    for (const auto& record : journal->records) {
+        if (record.sequence <= result.sequence) {
+            continue;
+        }
+
+        if (!result.meal.apply(record.edit)) {
+            fmt::print(stderr, fmt::fg(fmt::color::yellow),
+                "[WARNING]: Skipping journal record {} of {}, it edits a row that doesn't exist\n", record.sequence,
+                journal_path);
+        }
+        result.sequence = record.sequence;
+        replayed_count += 1;
+    }
+
+    const auto unknown_foods = std::erase_if(result.meal.rows, [](const Food& row) { return row.id == FoodId::Invalid; });
+    if (unknown_foods != 0) {
+        fmt::print(stderr, fmt::fg(fmt::color::red),
+            "[ERROR]: {} foods of the journal {} are not in the catalog, skipping them\n", unknown_foods, journal_path);
+    }
+
+    if (journal->is_torn) {
+        fmt::print(stderr, fmt::fg(fmt::color::yellow), "[WARNING]: The journal {} ends in a torn record, ignoring it\n",
+            journal_path);
+    }
+
+    if (replayed_count != 0) {
+        fmt::print("[INFO]: Replayed {} edits from {}\n", replayed_count, journal_path);
+    }
+
+    result.needs_compaction = !journal->records.empty() || journal->is_torn;
+    start_today();
+    return result;
+}
+
+AutoSaver::AutoSaver(std::filesystem::path snapshot_path, std::filesystem::path journal_path,
+    std::shared_ptr<HistoryStore> history, std::shared_ptr<const FoodCatalog> food_catalog, RecoveredMeal recovered,
+    std::function<void()> on_stored, const clock::duration debounce, const clock::duration max_delay)
+    : m_snapshot_path(std::move(snapshot_path))
+    , m_journal_path(std::move(journal_path))
+    , m_history(std::move(history))
+    , m_food_catalog(std::move(food_catalog))
+    , m_on_stored(std::move(on_stored))
+    , m_debounce(debounce)
+    , m_max_delay(max_delay)
+    , m_key(recovered.key)
+    , m_replica(std::move(recovered.meal))
+    , m_sequence(recovered.sequence) {
+    // Nothing can be appended after a torn record, so the journal has to start over first. That is the first save of
+    // the writer thread, so the UI thread doesn't wait for the snapshot and the history to be written.
+    if (!recovered.needs_compaction) {
+        m_journal = MealJournal::open(m_journal_path);
+    }
+    m_save_now = !m_journal.has_value();
+
+    m_thread = std::thread{ [this] { run(); } };
+}
+
+AutoSaver::~AutoSaver() {
+    {
+        const auto lock = std::scoped_lock{ m_mutex };
+        m_stop          = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void AutoSaver::submit(MealEdit edit) {
+    const auto now = clock::now();
+    {
+        const auto lock = std::scoped_lock{ m_mutex };
+        if (m_pending.empty()) {
+            m_first_submit_time = now;
+        }
+        // Every title and notes edit holds the whole text, only the last of a run of them needs to be saved
+        const auto is_text_edit = edit.kind == MealEdit::Kind::SetTitle || edit.kind == MealEdit::Kind::SetNotes;
+        if (is_text_edit && !m_pending.empty() && m_pending.back().kind == edit.kind) {
+            m_pending.back().text = std::move(edit.text);
+        } else {
+            m_pending.push_back(std::move(edit));
+        }
+        m_last_submit_time = now;
+    }
+    m_wake.notify_one();
+}
+
+void AutoSaver::save_now() {
+    {
+        const auto lock = std::scoped_lock{ m_mutex };
+        m_save_now      = true;
+    }
+    m_wake.notify_one();
+}
+
+void AutoSaver::run() {
+    PROFILE_THREAD("Autosaver");
+    MEMORY_TAG(MealModel);
+
+    auto edits = std::vector<MealEdit>{};
+    auto lock  = std::unique_lock{ m_mutex };
+
+    while (true) {
+        m_wake.wait(lock, [&] { return m_stop || m_save_now || !m_pending.empty(); });
+
+        // Wait for the edits to settle down, every new submit pushes the deadline back
+        while (!m_stop && !m_save_now) {
+            const auto deadline = std::min(m_last_submit_time + m_debounce, m_first_submit_time + m_max_delay);
+            if (clock::now() >= deadline) {
+                break;
+            }
+            m_wake.wait_until(lock, deadline);
+        }
+
+        // The edits are swapped out, so the UI thread can keep submitting while they get written
+        std::swap(edits, m_pending);
+        const auto stop    = m_stop;
+        const auto compact = std::exchange(m_save_now, false) || stop;
+
+        lock.unlock();
+        save(edits, compact);
+        edits.clear();
+        lock.lock();
+
+        if (stop) {
+            return;
+        }
+    }
+}
+
+void AutoSaver::save(std::vector<MealEdit>& edits, const bool compact) {
+    PROFILE_FUNCTION();
+
+    // Like on startup, the snapshot and journal move on to the new day once it starts. The meal edited past midnight
+    // becomes the new day's, the previous day keeps it as it was before these edits.
+    if (const auto day = today(); !edits.empty() && day != m_key.day) {
+        this->compact();
+        m_key = { .day = day, .meal = m_key.meal };
+        m_journal.reset();
+    }
+
+    m_encoded.clear();
+    for (const auto& edit : edits) {
+        if (!m_replica.apply(edit)) {
+            fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Dropping an edit of a row that doesn't exist\n");
+            continue;
+        }
+
+        m_sequence += 1;
+        MealJournal::encode({ .sequence = m_sequence, .edit = edit }, *m_food_catalog, m_encoded);
+    }
+    m_edits_since_compaction += edits.size();
+
+    // Nothing may follow a failed append, which might have left a torn record behind, until a new journal is started
+    if (m_journal.has_value() && !m_encoded.empty() && !m_journal->append(m_encoded)) {
+        m_journal.reset();
+    }
+
+    if (compact || !m_journal.has_value() || m_edits_since_compaction >= edits_per_compaction) {
+        this->compact();
+    }
+}
+
+void AutoSaver::compact() {
+    PROFILE_FUNCTION();
+
+    const auto snapshot = MealDocument{
+        .meals            = { { .day = m_key.day, .index = m_key.meal, .meal = m_replica } },
+        .journal_sequence = m_sequence,
+    };
+
+    // The new journal only starts once the snapshot is safely written, until then the old one is still needed
+    if (snapshot.save(m_snapshot_path, *m_food_catalog)) {
+        m_journal                = MealJournal::create(m_journal_path);
+        m_edits_since_compaction = 0;
+    }
+
+    if (m_history->store_meal(m_key, m_replica, *m_food_catalog) && m_on_stored) {
+        m_on_stored();
+    }
+}
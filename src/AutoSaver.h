@@ -0,0 +1,99 @@
+#pragma once
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <functional>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <filesystem>
+#include <condition_variable>
+#include "Meal.h"
+#include "MealJournal.h"
+#include "HistoryStore.h"
+#include "FoodCatalog.h"
+
+
+// A meal as it was last saved: its snapshot with the edits of its journal replayed on top
+struct RecoveredMeal {
+    MealKey key       = {};
+    MealSnapshot meal = {};
+    uint64_t sequence = 0;
+
+    // Set when the journal has to be folded into a new snapshot before anything can be appended to it
+    bool needs_compaction = false;
+};
+
+
+// Saves the meal being edited on a background thread. The UI thread only hands over the edits it makes, the writer
+// thread appends them to the meal's journal and applies them to its own replica of the meal. Every so often, and when
+// asked to save, the replica gets written as a new snapshot, stored into the history and the journal starts over, so
+// saving costs as much as the edits made rather than as much as the whole meal.
+//
+// Edits submitted in quick succession get coalesced into a single append, and a run of title or notes edits, which
+// typing submits on every keystroke, into its last edit. Snapshots atomically replace the previous ones, so neither a
+// crash while appending nor one while compacting ever loses what was saved before.
+class AutoSaver {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // The snapshot and journal only ever hold today's meal. A meal left over from an earlier day gets stored into the
+    // history, and today's meal is loaded from it instead. While running, the meal being edited carries over into the
+    // new day with its first edit past midnight.
+    [[nodiscard]] static RecoveredMeal recover(const std::filesystem::path& snapshot_path,
+        const std::filesystem::path& journal_path, HistoryStore& history, const FoodCatalog& food_catalog);
+
+    // Edits get appended once none was submitted for `debounce`, but no later than `max_delay` after the oldest
+    // unsaved one, so that editing without pause still gets saved. `on_stored` gets called on the writer thread every
+    // time the meal has been stored into the history.
+    AutoSaver(std::filesystem::path snapshot_path, std::filesystem::path journal_path,
+        std::shared_ptr<HistoryStore> history, std::shared_ptr<const FoodCatalog> food_catalog, RecoveredMeal recovered,
+        std::function<void()> on_stored = {}, clock::duration debounce = std::chrono::milliseconds{ 250 },
+        clock::duration max_delay = std::chrono::seconds{ 1 });
+
+    // Saves the pending edits and compacts the journal before returning
+    ~AutoSaver();
+
+    AutoSaver(const AutoSaver&)            = delete;
+    AutoSaver& operator=(const AutoSaver&) = delete;
+
+    void submit(MealEdit edit);
+
+    // Saves the pending edits right away, as a new snapshot
+    void save_now();
+
+private:
+    void run();
+    void save(std::vector<MealEdit>& edits, bool compact);
+    void compact();
+
+private:
+    std::filesystem::path m_snapshot_path;
+    std::filesystem::path m_journal_path;
+    std::shared_ptr<HistoryStore> m_history;
+    std::shared_ptr<const FoodCatalog> m_food_catalog;
+    std::function<void()> m_on_stored;
+    clock::duration m_debounce;
+    clock::duration m_max_delay;
+
+    // Only touched by the writer thread
+    MealKey m_key;
+    MealSnapshot m_replica;
+    uint64_t m_sequence = 0;
+    std::optional<MealJournal> m_journal;
+    size_t m_edits_since_compaction = 0;
+    std::string m_encoded;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<MealEdit> m_pending;
+    clock::time_point m_first_submit_time;
+    clock::time_point m_last_submit_time;
+    bool m_save_now = false;
+    bool m_stop     = false;
+
+    // Started last, once everything it uses is initialized
+    std::thread m_thread;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+
+// Helpers for the small binary formats that the app saves (meal journals, history chunks, meal documents). Values are written in the
+// native byte order, like the binary food catalog.
+namespace binary {
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+void put(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void put_string(std::string& out, const std::string_view string) {
+    put(out, static_cast<uint32_t>(string.size()));
+    out.append(string);
+}
+
+// Reads values back out of bytes written by `put`. Any read past the end fails and leaves the reader failed, so that
+// a whole record can be decoded first and validated once.
+class Reader {
+public:
+    explicit Reader(const std::string_view bytes)
+        : m_bytes(bytes) {}
+
+    [[nodiscard]] bool failed() const noexcept {
+        return m_failed;
+    }
+
+    [[nodiscard]] size_t remaining() const noexcept {
+        return m_bytes.size();
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    T get() {
+        auto value = T{};
+        if (m_failed || m_bytes.size() < sizeof(T)) {
+            m_failed = true;
+            return value;
+        }
+        std::memcpy(&value, m_bytes.data(), sizeof(T));
+        m_bytes.remove_prefix(sizeof(T));
+        return value;
+    }
+
+    std::string_view get_string() {
+        return get_bytes(get<uint32_t>());
+    }
+
+    // The next `size` bytes as they are, for arrays that get copied out element by element
+    std::string_view get_bytes(const size_t size) {
+        if (m_failed || m_bytes.size() < size) {
+            m_failed = true;
+            return {};
+        }
+        const auto bytes = m_bytes.substr(0, size);
+        m_bytes.remove_prefix(size);
+        return bytes;
+    }
+
+private:
+    std::string_view m_bytes;
+    bool m_failed = false;
+};
+
+} // namespace binary
@@ -0,0 +1,33 @@
+#include <cstdlib>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include "FoodCatalog.h"
+
+
+// Compiles the json food database into the binary catalog that the app memory maps on startup.
+// Usage: catalog_compiler [database.json] [database.bin]
+int main(int argc, char* argv[]) {
+    const auto json_path   = std::filesystem::path{ (argc > 1) ? argv[1] : "res/database.json" };
+    const auto binary_path = std::filesystem::path{ (argc > 2) ? argv[2] : "res/database.bin" };
+
+    // The source is stamped before parsing, so that edits made while compiling leave the catalog stale
+    const auto source = FoodCatalogSource::of(json_path);
+    if (!source.has_value()) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Could not open {}\n", json_path);
+        return EXIT_FAILURE;
+    }
+
+    const auto catalog = FoodCatalog::load_json(json_path);
+    if (!catalog.has_value()) {
+        return EXIT_FAILURE;
+    }
+
+    if (!catalog->write_binary(binary_path, *source)) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Could not write {}\n", binary_path);
+        return EXIT_FAILURE;
+    }
+
+    fmt::print("Compiled {} foods from {} into {}\n", catalog->size(), json_path, binary_path);
+    return EXIT_SUCCESS;
+}
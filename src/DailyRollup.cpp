@@ -0,0 +1,141 @@
+#include "DailyRollup.h"
+
+#include <algorithm>
+
+
+namespace {
+
+int32_t day_number(const std::chrono::sys_days day) noexcept {
+    return static_cast<int32_t>(day.time_since_epoch().count());
+}
+
+size_t lowest_bit(const size_t index) noexcept {
+    return index & (~index + 1);
+}
+
+} // namespace
+
+
+std::array<double, 5> RangeTotals::daily_means() const noexcept {
+    auto means = std::array<double, 5>{};
+    if (logged_days == 0) {
+        return means;
+    }
+
+    for (size_t column = 0; column < means.size(); ++column) {
+        means[column] = sums[column] / logged_days;
+    }
+    return means;
+}
+
+void DailyRollup::clear() noexcept {
+    m_first_day = 0;
+    m_day_sums.clear();
+    m_day_meals.clear();
+    m_tree.clear();
+}
+
+void DailyRollup::add(const std::chrono::sys_days day, const Totals& delta, const int32_t meal_delta) {
+    const auto number = day_number(day);
+    cover(number);
+
+    const auto index      = static_cast<size_t>(number - m_first_day);
+    const auto was_logged = m_day_meals[index] != 0;
+    m_day_meals[index]    = static_cast<uint32_t>(std::max(static_cast<int32_t>(m_day_meals[index]) + meal_delta, 0));
+
+    auto node = Node{ .sums = delta };
+    for (size_t column = 0; column < node.sums.size(); ++column) {
+        m_day_sums[index][column] += delta[column];
+    }
+
+    // The logged day count only changes when a day gets its first meal or loses its last one. It is unsigned, a
+    // decrement wraps around and wraps back when added.
+    const auto is_logged = m_day_meals[index] != 0;
+    if (is_logged != was_logged) {
+        node.logged_days = is_logged ? 1u : ~0u;
+    }
+    update(index + 1, node);
+}
+
+RangeTotals DailyRollup::query(const std::chrono::sys_days first, const std::chrono::sys_days last) const noexcept {
+    const auto day_count = static_cast<int64_t>(m_day_sums.size());
+    const auto begin     = std::clamp(static_cast<int64_t>(day_number(first)) - m_first_day, int64_t{ 0 }, day_count);
+    const auto end       = std::clamp(static_cast<int64_t>(day_number(last)) - m_first_day + 1, int64_t{ 0 }, day_count);
+    if (begin >= end) {
+        return {};
+    }
+
+    const auto upper = prefix(static_cast<size_t>(end));
+    const auto lower = prefix(static_cast<size_t>(begin));
+
+    auto totals = RangeTotals{ .logged_days = upper.logged_days - lower.logged_days };
+    for (size_t column = 0; column < totals.sums.size(); ++column) {
+        totals.sums[column] = upper.sums[column] - lower.sums[column];
+    }
+    return totals;
+}
+
+void DailyRollup::cover(const int32_t day) {
+    if (m_day_sums.empty()) {
+        m_first_day = day;
+    }
+
+    const auto day_count = static_cast<int32_t>(m_day_sums.size());
+    if (day >= m_first_day && day < m_first_day + day_count) {
+        return;
+    }
+
+    if (day < m_first_day) {
+        // Days before the first one are rare (importing older meals), the range is only grown as much as needed
+        const auto added = static_cast<size_t>(m_first_day - day);
+        m_day_sums.insert(m_day_sums.begin(), added, Totals{});
+        m_day_meals.insert(m_day_meals.begin(), added, 0);
+        m_first_day = day;
+    } else {
+        const auto needed = static_cast<size_t>(day - m_first_day) + 1;
+        const auto size   = std::max(needed, m_day_sums.size() * 2);
+        m_day_sums.resize(size);
+        m_day_meals.resize(size);
+    }
+    rebuild();
+}
+
+void DailyRollup::rebuild() {
+    // Linear construction: every node passes its sum on to its parent, the next node covering it
+    m_tree.assign(m_day_sums.size() + 1, Node{});
+    for (size_t index = 1; index < m_tree.size(); ++index) {
+        auto& node = m_tree[index];
+        for (size_t column = 0; column < node.sums.size(); ++column) {
+            node.sums[column] += m_day_sums[index - 1][column];
+        }
+        node.logged_days += m_day_meals[index - 1] != 0 ? 1u : 0u;
+
+        const auto parent = index + lowest_bit(index);
+        if (parent < m_tree.size()) {
+            for (size_t column = 0; column < node.sums.size(); ++column) {
+                m_tree[parent].sums[column] += node.sums[column];
+            }
+            m_tree[parent].logged_days += node.logged_days;
+        }
+    }
+}
+
+void DailyRollup::update(size_t index, const Node& delta) noexcept {
+    for (; index < m_tree.size(); index += lowest_bit(index)) {
+        for (size_t column = 0; column < delta.sums.size(); ++column) {
+            m_tree[index].sums[column] += delta.sums[column];
+        }
+        m_tree[index].logged_days += delta.logged_days;
+    }
+}
+
+DailyRollup::Node DailyRollup::prefix(size_t count) const noexcept {
+    auto sum = Node{};
+    for (; count > 0; count -= lowest_bit(count)) {
+        for (size_t column = 0; column < sum.sums.size(); ++column) {
+            sum.sums[column] += m_tree[count].sums[column];
+        }
+        sum.logged_days += m_tree[count].logged_days;
+    }
+    return sum;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+
+// Nutrient totals of a date range, summed over every meal eaten in it
+struct RangeTotals {
+    std::array<double, 5> sums = {};
+    uint32_t logged_days       = 0; // Days of the range with at least one meal
+
+    // Average per logged day, days without any meal don't pull the averages down
+    [[nodiscard]] std::array<double, 5> daily_means() const noexcept;
+};
+
+
+// Per-day nutrient totals with a Fenwick tree over them, so that the totals of any date range are answered in
+// O(log days) instead of by summing every meal in it. Updating the totals of a day costs O(log days) as well.
+//
+// Days are numbered from the earliest day added. Adding a day outside of the covered range rebuilds the tree in
+// O(days), growing it to twice its size at the end so that appending day after day stays amortized O(log days).
+class DailyRollup {
+public:
+    using Totals = std::array<double, 5>;
+
+    void clear() noexcept;
+
+    // Adds `delta` to the totals of `day`, along with `meal_delta` meals (negative when meals get removed)
+    void add(std::chrono::sys_days day, const Totals& delta, int32_t meal_delta);
+
+    [[nodiscard]] RangeTotals query(std::chrono::sys_days first, std::chrono::sys_days last) const noexcept;
+
+private:
+    struct Node {
+        Totals sums          = {};
+        uint32_t logged_days = 0;
+    };
+
+    void cover(int32_t day);
+    void rebuild();
+    void update(size_t index, const Node& delta) noexcept;
+
+    // Sum of the first `count` days
+    [[nodiscard]] Node prefix(size_t count) const noexcept;
+
+private:
+    int32_t m_first_day = 0;
+
+    // The day values, kept to rebuild the tree from when it has to grow
+    std::vector<Totals> m_day_sums;
+    std::vector<uint32_t> m_day_meals;
+
+    // 1-based, `m_tree[i]` holds the sum of the `i & -i` days ending at day `i - 1`
+    std::vector<Node> m_tree;
+};
@@ -0,0 +1,277 @@
+#include "FontAtlasCache.h"
+
+#include <span>
+#include <array>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include <imgui_internal.h>
+#include "BinaryIO.h"
+#include "AtomicFile.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+
+
+namespace {
+
+constexpr uint32_t cache_magic   = 0x4146544E; // "NTFA"
+constexpr uint32_t cache_version = 1;
+
+// Followed by the atlas' texture coordinates, the glyphs, the custom rects and finally the 8 bit texture itself
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    int32_t tex_width;
+    int32_t tex_height;
+    uint32_t glyph_count;
+    uint32_t custom_rect_count;
+    int32_t pack_id_mouse_cursors;
+    int32_t pack_id_lines;
+    float font_size;
+    float ascent;
+    float descent;
+    uint32_t reserved;
+};
+
+// The fields of `ImFontAtlasCustomRect` without its font pointer. Only rects without a font get cached.
+constexpr auto custom_rect_size =
+    4 * sizeof(unsigned short) + sizeof(unsigned int) + sizeof(float) + sizeof(ImVec2);
+
+// FNV-1a over 8 byte words, fast enough to hash the whole font on every launch
+uint64_t hash_bytes(uint64_t hash, const std::span<const std::byte> bytes) noexcept {
+    const auto tail = bytes.size() % sizeof(uint64_t);
+
+    for (size_t pos = 0; pos + tail < bytes.size(); pos += sizeof(uint64_t)) {
+        auto word = uint64_t{};
+        std::memcpy(&word, bytes.data() + pos, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3;
+    }
+
+    for (const auto byte : bytes.last(tail)) {
+        hash = (hash ^ static_cast<uint64_t>(byte)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+template <typename T>
+uint64_t hash_value(const uint64_t hash, const T& value) noexcept {
+    return hash_bytes(hash, std::as_bytes(std::span{ &value, 1 }));
+}
+
+// Everything that the built atlas depends on
+uint64_t atlas_key(const ImFontAtlas& atlas, const ImFontConfig& config, const std::span<const std::byte> font_data) {
+    auto hash = hash_bytes(0xcbf29ce484222325, font_data);
+    hash      = hash_value(hash, IMGUI_VERSION_NUM);
+    hash      = hash_value(hash, sizeof(ImFontGlyph));
+
+    hash = hash_value(hash, atlas.Flags);
+    hash = hash_value(hash, atlas.TexDesiredWidth);
+    hash = hash_value(hash, atlas.TexGlyphPadding);
+    hash = hash_value(hash, atlas.FontBuilderFlags);
+
+    hash = hash_value(hash, config.FontNo);
+    hash = hash_value(hash, config.SizePixels);
+    hash = hash_value(hash, config.OversampleH);
+    hash = hash_value(hash, config.OversampleV);
+    hash = hash_value(hash, config.PixelSnapH);
+    hash = hash_value(hash, config.GlyphExtraSpacing);
+    hash = hash_value(hash, config.GlyphOffset);
+    hash = hash_value(hash, config.GlyphMinAdvanceX);
+    hash = hash_value(hash, config.GlyphMaxAdvanceX);
+    hash = hash_value(hash, config.FontBuilderFlags);
+    hash = hash_value(hash, config.RasterizerMultiply);
+    hash = hash_value(hash, config.EllipsisChar);
+
+    for (const auto* range = config.GlyphRanges; range != nullptr && *range != 0; ++range) {
+        hash = hash_value(hash, *range);
+    }
+    return hash;
+}
+
+bool write_cache(const ImFontAtlas& atlas, const ImFont& font, const uint64_t key, const std::filesystem::path& path) {
+    PROFILE_FUNCTION();
+
+    // Rects of custom glyphs point into their font, which can't be saved
+    const auto custom_rects = std::span{ atlas.CustomRects.Data, static_cast<size_t>(atlas.CustomRects.Size) };
+    const auto has_custom_glyphs =
+        std::ranges::any_of(custom_rects, [](const ImFontAtlasCustomRect& rect) { return rect.Font != nullptr; });
+    if (atlas.TexPixelsAlpha8 == nullptr || has_custom_glyphs) {
+        return false;
+    }
+
+    auto header                  = Header{};
+    header.magic                 = cache_magic;
+    header.version               = cache_version;
+    header.key                   = key;
+    header.tex_width             = atlas.TexWidth;
+    header.tex_height            = atlas.TexHeight;
+    header.glyph_count           = static_cast<uint32_t>(font.Glyphs.Size);
+    header.custom_rect_count     = static_cast<uint32_t>(custom_rects.size());
+    header.pack_id_mouse_cursors = atlas.PackIdMouseCursors;
+    header.pack_id_lines         = atlas.PackIdLines;
+    header.font_size             = font.FontSize;
+    header.ascent                = font.Ascent;
+    header.descent               = font.Descent;
+
+    auto out = std::string{};
+    binary::put(out, header);
+    binary::put(out, atlas.TexUvScale);
+    binary::put(out, atlas.TexUvWhitePixel);
+    for (const auto& uv_line : atlas.TexUvLines) {
+        binary::put(out, uv_line);
+    }
+
+    for (const auto& glyph : font.Glyphs) {
+        binary::put(out, glyph);
+    }
+
+    for (const auto& rect : custom_rects) {
+        binary::put(out, rect.Width);
+        binary::put(out, rect.Height);
+        binary::put(out, rect.X);
+        binary::put(out, rect.Y);
+        binary::put(out, rect.GlyphID);
+        binary::put(out, rect.GlyphAdvanceX);
+        binary::put(out, rect.GlyphOffset);
+    }
+
+    const auto pixel_count = static_cast<size_t>(atlas.TexWidth) * static_cast<size_t>(atlas.TexHeight);
+    out.append(reinterpret_cast<const char*>(atlas.TexPixelsAlpha8), pixel_count);
+    return atomic_write_file(path, out);
+}
+
+// Sets up the font and the atlas exactly like building them would have, from the cache. Returns false, leaving the
+// atlas untouched, when there is no cache or it was built from something else.
+bool read_cache(ImFontAtlas& atlas, const ImFontConfig& config, const uint64_t key, const std::filesystem::path& path) {
+    PROFILE_FUNCTION();
+
+    const auto file  = MappedFile{ path };
+    const auto bytes = file.bytes();
+    auto reader      = binary::Reader{ { reinterpret_cast<const char*>(bytes.data()), bytes.size() } };
+
+    const auto header = reader.get<Header>();
+    if (reader.failed() || header.magic != cache_magic || header.version != cache_version || header.key != key) {
+        return false;
+    }
+
+    auto uv_lines               = std::array<ImVec4, IM_ARRAYSIZE(atlas.TexUvLines)>{};
+    const auto pixel_count      = static_cast<size_t>(header.tex_width) * static_cast<size_t>(header.tex_height);
+    const auto expected_remains = 2 * sizeof(ImVec2) + sizeof(uv_lines) + header.glyph_count * sizeof(ImFontGlyph) +
+        header.custom_rect_count * custom_rect_size + pixel_count;
+    if (header.tex_width <= 0 || header.tex_height <= 0 || reader.remaining() != expected_remains) {
+        fmt::print(stderr, fmt::fg(fmt::color::yellow), "[WARNING]: The font atlas cache {} is corrupt, rebuilding it\n",
+            path);
+        return false;
+    }
+
+    const auto uv_scale       = reader.get<ImVec2>();
+    const auto uv_white_pixel = reader.get<ImVec2>();
+    for (auto& uv_line : uv_lines) {
+        uv_line = reader.get<ImVec4>();
+    }
+
+    auto* font = IM_NEW(ImFont);
+    font->Glyphs.resize(static_cast<int>(header.glyph_count));
+    for (auto& glyph : font->Glyphs) {
+        glyph = reader.get<ImFontGlyph>();
+    }
+
+    auto custom_rects = ImVector<ImFontAtlasCustomRect>{};
+    custom_rects.resize(static_cast<int>(header.custom_rect_count));
+    for (auto& rect : custom_rects) {
+        rect.Width         = reader.get<unsigned short>();
+        rect.Height        = reader.get<unsigned short>();
+        rect.X             = reader.get<unsigned short>();
+        rect.Y             = reader.get<unsigned short>();
+        rect.GlyphID       = reader.get<unsigned int>();
+        rect.GlyphAdvanceX = reader.get<float>();
+        rect.GlyphOffset   = reader.get<ImVec2>();
+        rect.Font          = nullptr;
+    }
+
+    // The font data is only needed to rasterize the glyphs
+    auto font_config                 = config;
+    font_config.FontData             = nullptr;
+    font_config.FontDataSize         = 0;
+    font_config.FontDataOwnedByAtlas = false;
+    font_config.DstFont              = font;
+    atlas.ConfigData.push_back(font_config);
+    atlas.Fonts.push_back(font);
+
+    font->FontSize        = header.font_size;
+    font->Ascent          = header.ascent;
+    font->Descent         = header.descent;
+    font->ContainerAtlas  = &atlas;
+    font->ConfigData      = &atlas.ConfigData.back();
+    font->ConfigDataCount = 1;
+    font->BuildLookupTable();
+
+    atlas.CustomRects.swap(custom_rects);
+    atlas.PackIdMouseCursors = header.pack_id_mouse_cursors;
+    atlas.PackIdLines        = header.pack_id_lines;
+    atlas.TexWidth           = header.tex_width;
+    atlas.TexHeight          = header.tex_height;
+    atlas.TexUvScale         = uv_scale;
+    atlas.TexUvWhitePixel    = uv_white_pixel;
+    std::ranges::copy(uv_lines, atlas.TexUvLines);
+
+    // The atlas frees its texture with `IM_FREE`, and converts it to RGBA when the renderer asks for that
+    atlas.TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(pixel_count));
+    std::memcpy(atlas.TexPixelsAlpha8, bytes.last(pixel_count).data(), pixel_count);
+    atlas.TexReady = true;
+    return true;
+}
+
+} // namespace
+
+
+bool build_font_atlas(ImFontAtlas& atlas, const FontAtlasSpec& spec, const std::filesystem::path& cache_path) {
+    PROFILE_FUNCTION();
+
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto elapsed_ms = [&] {
+        return std::chrono::duration<double, std::milli>{ std::chrono::steady_clock::now() - start_time }.count();
+    };
+
+    const auto font_file = MappedFile{ spec.font_path };
+    if (!font_file.is_open()) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Font {} not found\n", spec.font_path);
+        return false;
+    }
+
+    auto config        = ImFontConfig{};
+    config.SizePixels  = spec.size_pixels;
+    config.GlyphRanges = spec.glyph_ranges;
+    const auto name    = fmt::format("{}, {:.0f}px", spec.font_path.filename().string(), spec.size_pixels);
+    fmt::format_to_n(config.Name, sizeof(config.Name) - 1, "{}", name);
+
+    const auto key = atlas_key(atlas, config, font_file.bytes());
+    if (atlas.Fonts.empty() && read_cache(atlas, config, key, cache_path)) {
+        fmt::print("[INFO]: Loaded the font atlas from {} in {:.1f}ms\n", cache_path, elapsed_ms());
+        return true;
+    }
+
+    // The atlas takes ownership of the font data and frees it with `IM_FREE`
+    const auto font_data = font_file.bytes();
+    auto* owned_data     = IM_ALLOC(font_data.size());
+    std::memcpy(owned_data, font_data.data(), font_data.size());
+
+    if (atlas.AddFontFromMemoryTTF(owned_data, static_cast<int>(font_data.size()), spec.size_pixels, &config,
+            spec.glyph_ranges) == nullptr ||
+        !atlas.Build()) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Could not build the font atlas from {}\n", spec.font_path);
+        return false;
+    }
+
+    if (!write_cache(atlas, *atlas.Fonts.back(), key, cache_path)) {
+        fmt::print(stderr, fmt::fg(fmt::color::yellow), "[WARNING]: Could not cache the font atlas in {}\n", cache_path);
+    }
+    fmt::print("[INFO]: Built the font atlas in {:.1f}ms\n", elapsed_ms());
+    return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <filesystem>
+#include <imgui.h>
+
+
+struct FontAtlasSpec {
+    std::filesystem::path font_path;
+    float size_pixels           = 0.0f;
+    const ImWchar* glyph_ranges = nullptr; // Zero terminated pairs, like ImGui's own glyph ranges
+};
+
+// Adds the font to `atlas` and builds the atlas. Rasterizing the glyphs takes a while, and longer with every size and
+// glyph range, so the built texture and glyph tables are cached at `cache_path`. The cache is keyed by the contents of
+// the font, its size, the atlas and font config and the glyph ranges, and is rebuilt whenever any of them changes.
+// Returns false when the font couldn't be loaded at all.
+bool build_font_atlas(ImFontAtlas& atlas, const FontAtlasSpec& spec, const std::filesystem::path& cache_path);
@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+using namespace std::literals;
+
+
+// Compact handle of a food inside of a `FoodCatalog`, it resolves to the food's props and name with an array index.
+// Names are only materialized when a meal gets serialized or displayed.
+enum class FoodId : uint32_t {
+    Invalid = UINT32_MAX
+};
+
+
+struct Food {
+    FoodId id                   = FoodId::Invalid;
+    std::array<float, 5> values = { 0.0f };
+
+    static constexpr auto value_names = std::array{ "protein"sv, "carbo"sv, "fat"sv, "calories"sv };
+
+    enum ValueIndex : size_t {
+        Protein = 0,
+        Carbo,
+        Fat,
+        Calories,
+        Weight
+    };
+
+    bool operator==(const Food&) const = default;
+};
+
+
+struct FoodProps {
+    std::array<float, 5> props = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+
+    [[nodiscard]] constexpr float get_value_from_weight(const Food::ValueIndex value, const float weight) const noexcept {
+        return (weight * props[value] / props[Food::Weight]);
+    }
+
+    [[nodiscard]] constexpr float get_value_from_weight(const size_t value_index, const float weight) const noexcept {
+        return get_value_from_weight(static_cast<Food::ValueIndex>(value_index), weight);
+    }
+
+    [[nodiscard]] constexpr float get_weight_from_value(const Food::ValueIndex value, const float weight) const noexcept {
+        return (weight * props[Food::Weight] / props[value]);
+    }
+
+    [[nodiscard]] constexpr float get_weight_from_value(const size_t value_index, const float weight) const noexcept {
+        return get_weight_from_value(static_cast<Food::ValueIndex>(value_index), weight);
+    }
+};
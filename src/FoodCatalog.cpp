@@ -0,0 +1,893 @@
+#include "FoodCatalog.h"
+
+#include <bit>
+#include <array>
+#include <chrono>
+#include <ranges>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <fstream>
+#include <numeric>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include <nlohmann/json.hpp>
+#include "AtomicFile.h"
+#include "MemoryStats.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+
+namespace {
+
+using json = nlohmann::json;
+
+uint64_t hash_name(const std::string_view name) noexcept {
+    // 64 bit FNV-1a
+    auto hash = uint64_t{ 0xcbf29ce484222325 };
+    for (const auto c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+// FNV-1a over 8 byte words instead of single bytes, which is fast enough to verify a whole catalog on every launch
+uint64_t checksum(const std::span<const std::byte> bytes) noexcept {
+    auto hash       = uint64_t{ 0xcbf29ce484222325 };
+    const auto tail = bytes.size() % sizeof(uint64_t);
+
+    for (size_t pos = 0; pos + tail < bytes.size(); pos += sizeof(uint64_t)) {
+        auto word = uint64_t{};
+        std::memcpy(&word, bytes.data() + pos, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3;
+    }
+
+    for (const auto byte : bytes.last(tail)) {
+        hash = (hash ^ static_cast<uint64_t>(byte)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+std::string_view name_at(const std::string_view name_pool, const std::span<const uint32_t> name_offsets, const size_t index) {
+    return name_pool.substr(name_offsets[index], name_offsets[index + 1] - name_offsets[index] - 1);
+}
+
+// Derives a new hash from a name's hash for every seed, using the splitmix64 finalizer. Seed 0 selects the bucket.
+uint64_t mix_hash(const uint64_t hash, const uint32_t seed) noexcept {
+    auto mixed = hash + (uint64_t{ seed } + 1) * 0x9e3779b97f4a7c15;
+    mixed      = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9;
+    mixed      = (mixed ^ (mixed >> 27)) * 0x94d049bb133111eb;
+    return mixed ^ (mixed >> 31);
+}
+
+struct PerfectHash {
+    std::vector<int32_t> displacements;
+    std::vector<uint32_t> slot_foods;
+};
+
+// Builds a minimal perfect hash over the (unique) names with the given hashes, using as many buckets as there are
+// names. The buckets with the most names get placed first, while the table is still empty, by searching for a seed
+// that sends every name of the bucket to a free slot. Buckets with a single name then simply take the remaining slots.
+PerfectHash build_perfect_hash(const std::vector<uint64_t>& hashes) {
+    const auto count = hashes.size();
+
+    auto result = PerfectHash{
+        .displacements = std::vector<int32_t>(count, 0),
+        .slot_foods    = std::vector<uint32_t>(count),
+    };
+    if (count == 0) {
+        return result;
+    }
+
+    // Group the foods by bucket
+    auto bucket_offsets = std::vector<uint32_t>(count + 1, 0);
+    for (const auto hash : hashes) {
+        bucket_offsets[mix_hash(hash, 0) % count + 1] += 1;
+    }
+    std::partial_sum(bucket_offsets.begin(), bucket_offsets.end(), bucket_offsets.begin());
+
+    auto bucket_foods = std::vector<uint32_t>(count);
+    auto bucket_fill  = std::vector<uint32_t>(bucket_offsets.begin(), bucket_offsets.end() - 1);
+    for (uint32_t food = 0; food < count; ++food) {
+        bucket_foods[bucket_fill[mix_hash(hashes[food], 0) % count]++] = food;
+    }
+
+    const auto bucket_size = [&](const uint32_t bucket) {
+        return bucket_offsets[bucket + 1] - bucket_offsets[bucket];
+    };
+
+    auto buckets = std::vector<uint32_t>{};
+    for (uint32_t bucket = 0; bucket < count; ++bucket) {
+        if (bucket_size(bucket) != 0) {
+            buckets.push_back(bucket);
+        }
+    }
+    std::ranges::stable_sort(buckets, std::greater{}, bucket_size);
+
+    auto is_slot_taken = std::vector<bool>(count, false);
+    auto bucket_slots  = std::vector<size_t>{};
+
+    // NOTE: This only terminates because names are unique. Two distinct names sharing their whole 64 bit hash would
+    // stall it too, but that is astronomically unlikely for any realistic number of foods.
+    auto next_free_slot = size_t{ 0 };
+    for (const auto bucket : buckets) {
+        const auto foods = std::span{ bucket_foods }.subspan(bucket_offsets[bucket], bucket_size(bucket));
+
+        if (foods.size() == 1) {
+            while (is_slot_taken[next_free_slot]) {
+                next_free_slot += 1;
+            }
+            is_slot_taken[next_free_slot]     = true;
+            result.slot_foods[next_free_slot] = foods.front();
+            result.displacements[bucket]      = -static_cast<int32_t>(next_free_slot) - 1;
+            continue;
+        }
+
+        for (uint32_t seed = 1;; ++seed) {
+            bucket_slots.clear();
+            for (const auto food : foods) {
+                const auto slot = mix_hash(hashes[food], seed) % count;
+                if (is_slot_taken[slot] || std::ranges::find(bucket_slots, slot) != bucket_slots.end()) {
+                    break;
+                }
+                bucket_slots.push_back(slot);
+            }
+
+            if (bucket_slots.size() == foods.size()) {
+                for (size_t index = 0; index < foods.size(); ++index) {
+                    is_slot_taken[bucket_slots[index]]     = true;
+                    result.slot_foods[bucket_slots[index]] = foods[index];
+                }
+                result.displacements[bucket] = static_cast<int32_t>(seed);
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+// Streams the json database straight into a `FoodCatalogBuilder`, without ever building a json DOM. Every food is
+// validated against `Food::value_names` as it goes by, and invalid foods are skipped and recorded instead of aborting.
+class FoodDatabaseSax {
+public:
+    struct SkippedFood {
+        std::string name;
+        std::string reason;
+    };
+
+    explicit FoodDatabaseSax(FoodCatalogBuilder& builder)
+        : m_builder(builder) {}
+
+    bool null() {
+        return on_value(std::nullopt);
+    }
+
+    bool boolean(bool /*value*/) {
+        return on_value(std::nullopt);
+    }
+
+    bool number_integer(const json::number_integer_t value) {
+        return on_value(static_cast<float>(value));
+    }
+
+    bool number_unsigned(const json::number_unsigned_t value) {
+        return on_value(static_cast<float>(value));
+    }
+
+    bool number_float(const json::number_float_t value, const json::string_t& /*text*/) {
+        return on_value(static_cast<float>(value));
+    }
+
+    bool string(json::string_t& /*value*/) {
+        return on_value(std::nullopt);
+    }
+
+    bool binary(json::binary_t& /*value*/) {
+        return on_value(std::nullopt);
+    }
+
+    bool start_object(size_t /*element_count*/) {
+        if (m_depth == 1) {
+            m_in_food_object = true;
+        } else if (is_food_value()) {
+            skip_food(fmt::format("'{}' is not a number", Food::value_names[*m_value_index]));
+        }
+
+        m_depth += 1;
+        return true;
+    }
+
+    bool start_array(size_t /*element_count*/) {
+        if (m_depth == 0) {
+            m_error = "the database is not a json object";
+            return false;
+        }
+
+        if (m_depth == 1) {
+            skip_food("the food is not a json object");
+        } else if (is_food_value()) {
+            skip_food(fmt::format("'{}' is not a number", Food::value_names[*m_value_index]));
+        }
+
+        m_depth += 1;
+        return true;
+    }
+
+    bool end_object() {
+        return end_container();
+    }
+
+    bool end_array() {
+        return end_container();
+    }
+
+    bool key(json::string_t& key) {
+        if (m_depth == 1) {
+            begin_food(key);
+            return true;
+        }
+
+        if (m_depth != 2 || !m_in_food_object || !m_skip_reason.empty()) {
+            return true;
+        }
+
+        const auto* it = std::ranges::find(Food::value_names, std::string_view{ key });
+        if (it == Food::value_names.end()) {
+            skip_food(fmt::format("unknown value '{}'", key));
+            return true;
+        }
+
+        m_value_index = static_cast<size_t>(it - Food::value_names.begin());
+        if (m_seen_values[*m_value_index]) {
+            skip_food(fmt::format("'{}' appears more than once", key));
+        }
+        m_seen_values[*m_value_index] = true;
+        return true;
+    }
+
+    bool parse_error(size_t position, const std::string& /*last_token*/, const nlohmann::detail::exception& exception) {
+        m_error = fmt::format("syntax error at byte {}: {}", position, exception.what());
+        return false;
+    }
+
+    [[nodiscard]] const std::vector<SkippedFood>& skipped_foods() const noexcept {
+        return m_skipped_foods;
+    }
+
+    [[nodiscard]] size_t added_food_count() const noexcept {
+        return m_added_food_count;
+    }
+
+    // Set when parsing had to stop early, everything parsed up to that point is still in the builder
+    [[nodiscard]] const std::string& error() const noexcept {
+        return m_error;
+    }
+
+private:
+    [[nodiscard]] bool is_food_value() const noexcept {
+        return m_depth == 2 && m_in_food_object && m_skip_reason.empty() && m_value_index.has_value();
+    }
+
+    bool on_value(const std::optional<float> value) {
+        if (m_depth == 1) {
+            skip_food("the food is not a json object");
+            end_food();
+        } else if (is_food_value()) {
+            if (value.has_value()) {
+                m_food_props.props[*m_value_index] = *value;
+            } else {
+                skip_food(fmt::format("'{}' is not a number", Food::value_names[*m_value_index]));
+            }
+        }
+        return true;
+    }
+
+    bool end_container() {
+        m_depth -= 1;
+        if (m_depth == 1) {
+            end_food();
+        }
+        return true;
+    }
+
+    void begin_food(const std::string_view name) {
+        m_food_name.assign(name);
+        m_food_props     = FoodProps{};
+        m_seen_values    = {};
+        m_value_index    = std::nullopt;
+        m_in_food_object = false;
+        m_skip_reason.clear();
+    }
+
+    void skip_food(std::string reason) {
+        if (m_skip_reason.empty()) {
+            m_skip_reason = std::move(reason);
+        }
+    }
+
+    void end_food() {
+        const auto missing_value = std::ranges::find(m_seen_values, false);
+        if (m_skip_reason.empty() && missing_value != m_seen_values.end()) {
+            const auto index = static_cast<size_t>(missing_value - m_seen_values.begin());
+            skip_food(fmt::format("'{}' is missing", Food::value_names[index]));
+        }
+
+        if (m_skip_reason.empty()) {
+            m_builder.add(m_food_name, m_food_props);
+            m_added_food_count += 1;
+        } else {
+            m_skipped_foods.push_back({ .name = m_food_name, .reason = std::move(m_skip_reason) });
+        }
+
+        m_in_food_object = false;
+        m_skip_reason.clear();
+    }
+
+private:
+    FoodCatalogBuilder& m_builder;
+
+    // 0 is outside of the database, 1 is inside the database object and 2 is inside of a food object
+    size_t m_depth = 0;
+
+    std::string m_food_name;
+    FoodProps m_food_props;
+    std::array<bool, Food::value_names.size()> m_seen_values = {};
+    std::optional<size_t> m_value_index;
+    bool m_in_food_object = false;
+    std::string m_skip_reason;
+
+    size_t m_added_food_count = 0;
+    std::vector<SkippedFood> m_skipped_foods;
+    std::string m_error;
+};
+
+struct ParsedShard {
+    FoodCatalogBuilder builder;
+    std::vector<FoodDatabaseSax::SkippedFood> skipped_foods;
+    size_t added_food_count = 0;
+    std::string error;
+};
+
+// Iterates over the members of a shard as if they were a database of their own, wrapped in braces, so that the shard
+// can be parsed where it is in the file rather than copied first
+class BracedIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = char;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const char*;
+    using reference         = char;
+
+    BracedIterator() = default;
+    BracedIterator(const std::string_view members, const size_t position)
+        : m_members(members)
+        , m_position(position) {}
+
+    // The end of the members of `members`, past their closing brace
+    [[nodiscard]] static BracedIterator end(const std::string_view members) {
+        return { members, members.size() + 2 };
+    }
+
+    char operator*() const noexcept {
+        if (m_position == 0) {
+            return '{';
+        }
+        return m_position <= m_members.size() ? m_members[m_position - 1] : '}';
+    }
+
+    BracedIterator& operator++() noexcept {
+        m_position += 1;
+        return *this;
+    }
+
+    BracedIterator operator++(int) noexcept {
+        auto previous = *this;
+        m_position += 1;
+        return previous;
+    }
+
+    bool operator==(const BracedIterator& other) const noexcept {
+        return m_position == other.m_position;
+    }
+
+private:
+    std::string_view m_members;
+    size_t m_position = 0;
+};
+
+// Parses either a stream of the whole database or the iterators of a shard
+template <typename... Input>
+ParsedShard parse_shard(Input&&... input) {
+    PROFILE_FUNCTION();
+    MEMORY_TAG(Catalog);
+
+    auto result = ParsedShard{};
+    auto sax    = FoodDatabaseSax{ result.builder };
+    json::sax_parse(std::forward<Input>(input)..., &sax);
+
+    result.skipped_foods    = sax.skipped_foods();
+    result.added_food_count = sax.added_food_count();
+    result.error            = sax.error();
+    return result;
+}
+
+// Parsing is what dominates loading a big database, every thread parses a shard of at least this size
+constexpr auto min_shard_size = size_t{ 256 * 1024 };
+
+// Splits the members of the database object into about `shard_count` runs of whole members, at the commas between
+// them, so that every run can be parsed on its own. This takes a single pass that only tracks strings and nesting,
+// which is much faster than parsing. Returns nothing when the text isn't a plain json object with members, a
+// sequential parse then reports whatever is wrong with it exactly where it is.
+std::vector<std::string_view> split_database(const std::string_view text, const size_t shard_count) {
+    PROFILE_FUNCTION();
+
+    const auto begin = text.find_first_not_of(" \t\r\n");
+    if (shard_count < 2 || begin == std::string_view::npos || text[begin] != '{') {
+        return {};
+    }
+
+    const auto shard_size = text.size() / shard_count;
+    auto shards           = std::vector<std::string_view>{};
+    auto shard_begin      = begin + 1;
+    auto depth            = size_t{ 0 };
+    auto in_string        = false;
+
+    for (auto pos = begin; pos < text.size(); ++pos) {
+        const auto c = text[pos];
+        if (in_string) {
+            if (c == '\\') {
+                pos += 1;
+            } else if (c == '"') {
+                in_string = false;
+            }
+            continue;
+        }
+
+        if (c == '"') {
+            in_string = true;
+        } else if (c == '{' || c == '[') {
+            depth += 1;
+        } else if ((c == '}' || c == ']') && depth > 0) {
+            depth -= 1;
+            if (depth == 0) {
+                shards.push_back(text.substr(shard_begin, pos - shard_begin));
+
+                // Anything after the object, or an empty shard from a stray comma, makes the text invalid json
+                const auto is_blank = [](const std::string_view shard) {
+                    return shard.find_first_not_of(" \t\r\n") == std::string_view::npos;
+                };
+                if (shards.size() < 2 || !is_blank(text.substr(pos + 1)) || std::ranges::any_of(shards, is_blank)) {
+                    return {};
+                }
+                return shards;
+            }
+        } else if (c == ',' && depth == 1 && pos - shard_begin >= shard_size) {
+            shards.push_back(text.substr(shard_begin, pos - shard_begin));
+            shard_begin = pos + 1;
+        }
+    }
+    return {};
+}
+
+} // namespace
+
+
+std::optional<FoodCatalogSource> FoodCatalogSource::of(const std::filesystem::path& path) {
+    auto error      = std::error_code{};
+    const auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        return std::nullopt;
+    }
+
+    const auto last_write_time = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return std::nullopt;
+    }
+
+    return FoodCatalogSource{
+        .size            = static_cast<uint64_t>(size),
+        .last_write_time = int64_t{ last_write_time.time_since_epoch().count() },
+    };
+}
+
+FoodCatalog::FoodCatalog() {
+    // Even an empty catalog has a valid image, so that it can be written out like any other
+    const auto name_offsets = std::array<uint32_t, 1>{ 0 };
+    assign_image(layout_image({}, name_offsets, {}), {});
+}
+
+std::optional<FoodCatalog> FoodCatalog::load(
+    const std::filesystem::path& binary_path, const std::filesystem::path& json_path) {
+    PROFILE_FUNCTION();
+    MEMORY_TAG(Catalog);
+
+    const auto source = FoodCatalogSource::of(json_path);
+    if (auto catalog = load_binary(binary_path, source)) {
+        return catalog;
+    }
+
+    if (!source.has_value()) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Neither {} nor {} could be loaded\n", binary_path, json_path);
+        return std::nullopt;
+    }
+
+    fmt::print(stderr, fmt::fg(fmt::color::yellow), "[WARNING]: {} is missing or stale, parsing {} instead\n",
+        binary_path, json_path);
+    auto catalog = load_json(json_path);
+
+    // Rebuilt like `catalog_compiler` would, so that only the first launch after the database changed parses it
+    if (catalog.has_value()) {
+        if (catalog->write_binary(binary_path, *source)) {
+            fmt::print("[INFO]: Rebuilt {} from {}\n", binary_path, json_path);
+        } else {
+            fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Could not rebuild {}\n", binary_path);
+        }
+    }
+    return catalog;
+}
+
+std::optional<FoodCatalog> FoodCatalog::load_binary(
+    const std::filesystem::path& path, const std::optional<FoodCatalogSource>& expected_source) {
+    PROFILE_FUNCTION();
+
+    auto mapped_image = MappedFile{ path };
+    const auto image  = mapped_image.bytes();
+
+    if (image.size() < sizeof(Header)) {
+        return std::nullopt;
+    }
+
+    auto header = Header{};
+    std::memcpy(&header, image.data(), sizeof(header));
+
+    if (header.magic != file_magic || header.version != file_version) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: {} is not a version {} food catalog\n", path, file_version);
+        return std::nullopt;
+    }
+
+    const auto source = FoodCatalogSource{ .size = header.source_size, .last_write_time = header.source_last_write_time };
+    if (expected_source.has_value() && source != *expected_source) {
+        return std::nullopt;
+    }
+
+    if (checksum(image.subspan(sizeof(Header))) != header.checksum) {
+        fmt::print(
+            stderr, fmt::fg(fmt::color::red), "[ERROR]: The checksum of {} doesn't match, the file is corrupt\n", path);
+        return std::nullopt;
+    }
+
+    auto catalog = FoodCatalog{};
+    if (!catalog.assign_image({}, std::move(mapped_image))) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: The layout of {} is invalid\n", path);
+        return std::nullopt;
+    }
+    return catalog;
+}
+
+std::optional<FoodCatalog> FoodCatalog::load_json(const std::filesystem::path& path) {
+    PROFILE_FUNCTION();
+    MEMORY_TAG(Catalog);
+
+    auto file = std::ifstream{ path, std::ios::binary };
+    if (!file) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Could not open {}\n", path);
+        return std::nullopt;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // Only a database big enough to be split gets mapped, the shards are then parsed right out of the mapping. Anything
+    // else streams from the file, so that loading never holds a copy of the whole database.
+    auto error                  = std::error_code{};
+    const auto size             = std::filesystem::file_size(path, error);
+    const auto hardware_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const auto thread_count     = std::min(hardware_threads, error ? 0 : static_cast<size_t>(size) / min_shard_size);
+
+    const auto mapped_file = (thread_count > 1) ? MappedFile{ path } : MappedFile{};
+    const auto bytes       = mapped_file.bytes();
+    const auto text        = std::string_view{ reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+
+    // Shards are parsed in parallel into builders of their own, then appended in order, so foods keep the ids they
+    // would get from parsing the whole database in one go
+    const auto shards  = split_database(text, thread_count);
+    auto parsed_shards = std::vector<ParsedShard>{};
+    if (!shards.empty()) {
+        auto pool    = ThreadPool{ shards.size(), "Catalog" };
+        auto pending = std::vector<std::future<ParsedShard>>{};
+        for (const auto shard : shards) {
+            pending.push_back(pool.submit([shard] {
+                return parse_shard(BracedIterator{ shard, 0 }, BracedIterator::end(shard));
+            }));
+        }
+        for (auto& future : pending) {
+            parsed_shards.push_back(future.get());
+        }
+    }
+
+    // Syntax errors are reported relative to the shard they are in, so a broken database gets parsed again in one go,
+    // which reports them exactly where they are in the file
+    const auto has_parse_error = std::ranges::any_of(parsed_shards, [](const ParsedShard& shard) {
+        return !shard.error.empty();
+    });
+    if (shards.empty() || has_parse_error) {
+        parsed_shards.clear();
+        parsed_shards.push_back(parse_shard(file));
+    }
+
+    // A syntax error keeps the foods before it but drops everything after it
+    auto builder          = FoodCatalogBuilder{};
+    auto skipped_foods    = std::vector<FoodDatabaseSax::SkippedFood>{};
+    auto added_food_count = size_t{ 0 };
+    auto parse_error      = std::string{};
+    for (auto& shard : parsed_shards) {
+        builder.append(std::move(shard.builder));
+        skipped_foods.insert(skipped_foods.end(), std::make_move_iterator(shard.skipped_foods.begin()),
+            std::make_move_iterator(shard.skipped_foods.end()));
+        added_food_count += shard.added_food_count;
+
+        if (!shard.error.empty()) {
+            parse_error = std::move(shard.error);
+            break;
+        }
+    }
+
+    auto catalog = std::move(builder).build();
+
+    const auto elapsed_time = std::chrono::duration<double>{ std::chrono::steady_clock::now() - start_time };
+    const auto foods_per_second =
+        (elapsed_time.count() > 0.0) ? static_cast<double>(added_food_count) / elapsed_time.count() : 0.0;
+
+    // Only the first few skipped foods are listed, a broken database could otherwise flood the terminal
+    constexpr auto max_listed_skipped_foods = size_t{ 10 };
+    for (const auto& skipped : skipped_foods | std::views::take(max_listed_skipped_foods)) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Skipped the food '{}' in {}: {}\n", skipped.name, path,
+            skipped.reason);
+    }
+    if (skipped_foods.size() > max_listed_skipped_foods) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: ... and {} more invalid foods in {}\n",
+            skipped_foods.size() - max_listed_skipped_foods, path);
+    }
+
+    if (!parse_error.empty()) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Stopped reading {} after {} foods, {}\n", path,
+            added_food_count, parse_error);
+    }
+
+    fmt::print("[INFO]: Loaded {} foods from {} in {:.1f}ms ({:.0f} foods/s) on {} threads, skipped {}\n",
+        catalog.size(), path, elapsed_time.count() * 1000.0, foods_per_second, parsed_shards.size(),
+        skipped_foods.size());
+    return catalog;
+}
+
+bool FoodCatalog::write_binary(const std::filesystem::path& path, const FoodCatalogSource& source) const {
+    const auto body = m_image.subspan(sizeof(Header));
+
+    auto header = Header{};
+    std::memcpy(&header, m_image.data(), sizeof(header));
+    header.source_size            = source.size;
+    header.source_last_write_time = source.last_write_time;
+    header.checksum               = checksum(body);
+
+    // Replaced rather than truncated: a crash midway can't leave a torn catalog behind, and an app that has the old
+    // one mapped keeps reading it intact
+    auto contents = std::string(sizeof(header) + body.size(), '\0');
+    std::memcpy(contents.data(), &header, sizeof(header));
+    std::memcpy(contents.data() + sizeof(header), body.data(), body.size());
+    return atomic_write_file(path, contents);
+}
+
+std::optional<FoodId> FoodCatalog::find_id(const std::string_view name) const noexcept {
+    if (m_slot_foods.empty()) {
+        return std::nullopt;
+    }
+
+    const auto hash         = hash_name(name);
+    const auto count        = m_slot_foods.size();
+    const auto displacement = m_displacements[mix_hash(hash, 0) % count];
+
+    // The hash is perfect for the names in the catalog, so only a single name has to be compared to rule out the
+    // names that aren't in it
+    const auto slot = (displacement < 0) ? static_cast<size_t>(-(displacement + 1))
+                                         : mix_hash(hash, static_cast<uint32_t>(displacement)) % count;
+    const auto id = id_at(m_slot_foods[slot]);
+    return (this->name(id) == name) ? std::optional{ id } : std::nullopt;
+}
+
+const FoodProps* FoodCatalog::find(const std::string_view name) const noexcept {
+    const auto id = find_id(name);
+    return id.has_value() ? &props(*id) : nullptr;
+}
+
+std::vector<std::byte> FoodCatalog::layout_image(
+    const std::span<const FoodProps> props, const std::span<const uint32_t> name_offsets, const std::string_view name_pool) {
+    const auto food_count = props.size();
+
+    auto hashes = std::vector<uint64_t>(food_count);
+    for (size_t index = 0; index < food_count; ++index) {
+        hashes[index] = hash_name(name_at(name_pool, name_offsets, index));
+    }
+    const auto perfect_hash = build_perfect_hash(hashes);
+
+    const auto header = Header{
+        .magic                  = file_magic,
+        .version                = file_version,
+        .food_count             = static_cast<uint32_t>(food_count),
+        .bucket_count           = static_cast<uint32_t>(perfect_hash.displacements.size()),
+        .name_pool_size         = name_pool.size(),
+        .source_size            = 0,
+        .source_last_write_time = 0,
+        .checksum               = 0,
+    };
+
+    const auto displacements = std::span<const int32_t>{ perfect_hash.displacements };
+    const auto slot_foods    = std::span<const uint32_t>{ perfect_hash.slot_foods };
+
+    auto image = std::vector<std::byte>(sizeof(Header) + props.size_bytes() + name_offsets.size_bytes() +
+        displacements.size_bytes() + slot_foods.size_bytes() + name_pool.size());
+
+    auto* out = image.data();
+    const auto append = [&](const void* data, const size_t size) {
+        if (size != 0) {
+            std::memcpy(out, data, size);
+            out += size;
+        }
+    };
+
+    append(&header, sizeof(header));
+    append(props.data(), props.size_bytes());
+    append(name_offsets.data(), name_offsets.size_bytes());
+    append(displacements.data(), displacements.size_bytes());
+    append(slot_foods.data(), slot_foods.size_bytes());
+    append(name_pool.data(), name_pool.size());
+    return image;
+}
+
+bool FoodCatalog::assign_image(std::vector<std::byte> owned_image, MappedFile mapped_image) {
+    const auto image = owned_image.empty() ? mapped_image.bytes() : std::span<const std::byte>{ owned_image };
+    if (image.size() < sizeof(Header)) {
+        return false;
+    }
+
+    auto header = Header{};
+    std::memcpy(&header, image.data(), sizeof(header));
+
+    const auto food_count         = uint64_t{ header.food_count };
+    const auto props_size         = food_count * sizeof(FoodProps);
+    const auto name_offsets_size  = (food_count + 1) * sizeof(uint32_t);
+    const auto displacements_size = food_count * sizeof(int32_t);
+    const auto slot_foods_size    = food_count * sizeof(uint32_t);
+    const auto expected_size =
+        sizeof(Header) + props_size + name_offsets_size + displacements_size + slot_foods_size + header.name_pool_size;
+
+    if (image.size() != expected_size || header.bucket_count != header.food_count) {
+        return false;
+    }
+
+    const auto* data  = image.data() + sizeof(Header);
+    const auto* props = reinterpret_cast<const FoodProps*>(data);
+    data += props_size;
+    const auto* name_offsets = reinterpret_cast<const uint32_t*>(data);
+    data += name_offsets_size;
+    const auto* displacements = reinterpret_cast<const int32_t*>(data);
+    data += displacements_size;
+    const auto* slot_foods = reinterpret_cast<const uint32_t*>(data);
+    data += slot_foods_size;
+    const auto* name_pool = reinterpret_cast<const char*>(data);
+
+    // Names, slots and foods are all accessed without any bounds checks later on, so they have to be sane
+    if (name_offsets[0] != 0 || name_offsets[food_count] != header.name_pool_size) {
+        return false;
+    }
+    for (size_t index = 0; index < food_count; ++index) {
+        const auto has_valid_name =
+            name_offsets[index + 1] > name_offsets[index] && name_pool[name_offsets[index + 1] - 1] == '\0';
+        const auto has_valid_slot =
+            displacements[index] >= -static_cast<int64_t>(food_count) && slot_foods[index] < food_count;
+
+        if (!has_valid_name || !has_valid_slot) {
+            return false;
+        }
+    }
+
+    m_owned_image   = std::move(owned_image);
+    m_mapped_image  = std::move(mapped_image);
+    m_image         = image;
+    m_props         = { props, food_count };
+    m_name_offsets  = { name_offsets, food_count + 1 };
+    m_displacements = { displacements, food_count };
+    m_slot_foods    = { slot_foods, food_count };
+    m_name_pool     = name_pool;
+    return true;
+}
+
+void FoodCatalogBuilder::reserve(const size_t food_count) {
+    m_props.reserve(food_count);
+    m_name_offsets.reserve(food_count + 1);
+}
+
+void FoodCatalogBuilder::add(const std::string_view name, const FoodProps& props) {
+    m_props.push_back(props);
+    m_name_pool.append(name);
+    m_name_pool.push_back('\0');
+    m_name_offsets.push_back(static_cast<uint32_t>(m_name_pool.size()));
+}
+
+void FoodCatalogBuilder::append(FoodCatalogBuilder&& other) {
+    const auto name_pool_size = static_cast<uint32_t>(m_name_pool.size());
+
+    m_props.insert(m_props.end(), other.m_props.begin(), other.m_props.end());
+    for (const auto offset : std::span{ other.m_name_offsets }.subspan(1)) {
+        m_name_offsets.push_back(name_pool_size + offset);
+    }
+    m_name_pool.append(other.m_name_pool);
+    other = {};
+}
+
+void FoodCatalogBuilder::remove_duplicates() {
+    const auto food_count = m_props.size();
+
+    // Sorting by hash puts equal names next to each other, and by index within a hash, the last duplicate last
+    auto hashed_foods = std::vector<std::pair<uint64_t, uint32_t>>(food_count);
+    for (uint32_t index = 0; index < food_count; ++index) {
+        hashed_foods[index] = { hash_name(name_at(m_name_pool, m_name_offsets, index)), index };
+    }
+    std::ranges::sort(hashed_foods);
+
+    auto is_shadowed = std::vector<bool>(food_count, false);
+    auto has_shadows = false;
+
+    for (size_t first = 0, last = 0; first < food_count; first = last) {
+        while (last < food_count && hashed_foods[last].first == hashed_foods[first].first) {
+            last += 1;
+        }
+
+        for (auto index = first; index + 1 < last; ++index) {
+            const auto food = hashed_foods[index].second;
+            const auto name = name_at(m_name_pool, m_name_offsets, food);
+
+            for (auto other = index + 1; other < last; ++other) {
+                if (name_at(m_name_pool, m_name_offsets, hashed_foods[other].second) == name) {
+                    is_shadowed[food] = true;
+                    has_shadows       = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!has_shadows) {
+        return;
+    }
+
+    auto props        = std::vector<FoodProps>{};
+    auto name_offsets = std::vector<uint32_t>{ 0 };
+    auto name_pool    = std::string{};
+
+    for (uint32_t index = 0; index < food_count; ++index) {
+        if (!is_shadowed[index]) {
+            props.push_back(m_props[index]);
+            name_pool.append(name_at(m_name_pool, m_name_offsets, index));
+            name_pool.push_back('\0');
+            name_offsets.push_back(static_cast<uint32_t>(name_pool.size()));
+        }
+    }
+
+    m_props        = std::move(props);
+    m_name_offsets = std::move(name_offsets);
+    m_name_pool    = std::move(name_pool);
+}
+
+FoodCatalog FoodCatalogBuilder::build() && {
+    // Later duplicates replace earlier ones, just like repeated keys of a json object do
+    remove_duplicates();
+
+    auto catalog = FoodCatalog{};
+    catalog.assign_image(FoodCatalog::layout_image(m_props, m_name_offsets, m_name_pool), {});
+    return catalog;
+}
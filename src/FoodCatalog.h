@@ -0,0 +1,152 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <filesystem>
+#include <string_view>
+#include "Food.h"
+#include "MappedFile.h"
+
+
+// Identifies the json database that a binary catalog was compiled from. A binary catalog whose source doesn't match the
+// current json database is stale.
+struct FoodCatalogSource {
+    uint64_t size           = 0;
+    int64_t last_write_time = 0;
+
+    [[nodiscard]] static std::optional<FoodCatalogSource> of(const std::filesystem::path& path);
+    bool operator==(const FoodCatalogSource&) const = default;
+};
+
+
+// Read-only table of the nutritional values of every known food.
+//
+// The catalog is one flat image, laid out exactly like the binary catalog file: a header, followed by the `FoodProps`
+// of every food, the offsets of their names, a minimal perfect hash over the names and finally the pool of null
+// terminated names. A compiled catalog file is memory mapped and used in place, without any parsing. When it is stale,
+// the same image gets built in memory from the json database instead.
+class FoodCatalog {
+public:
+    static constexpr uint32_t file_magic   = 0x4346544E; // "NTFC"
+    static constexpr uint32_t file_version = 2;
+
+    FoodCatalog();
+
+    FoodCatalog(const FoodCatalog&)            = delete;
+    FoodCatalog& operator=(const FoodCatalog&) = delete;
+    FoodCatalog(FoodCatalog&&)                 = default;
+    FoodCatalog& operator=(FoodCatalog&&)      = default;
+
+    // Maps the binary catalog at `binary_path` if it was compiled from the current `json_path`, and otherwise parses
+    // `json_path` and rebuilds the binary catalog from it. Returns `std::nullopt` only when neither could be loaded.
+    [[nodiscard]] static std::optional<FoodCatalog> load(
+        const std::filesystem::path& binary_path, const std::filesystem::path& json_path);
+
+    // `expected_source` being set makes this fail when the file was compiled from a different json database
+    [[nodiscard]] static std::optional<FoodCatalog> load_binary(
+        const std::filesystem::path& path, const std::optional<FoodCatalogSource>& expected_source);
+    [[nodiscard]] static std::optional<FoodCatalog> load_json(const std::filesystem::path& path);
+
+    bool write_binary(const std::filesystem::path& path, const FoodCatalogSource& source) const;
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_props.size();
+    }
+
+    // Bytes of the whole image, mapped or built in memory
+    [[nodiscard]] size_t image_size() const noexcept {
+        return m_image.size();
+    }
+
+    // Foods are numbered in the order in which they appear in the json database
+    [[nodiscard]] static FoodId id_at(const size_t index) noexcept {
+        return static_cast<FoodId>(index);
+    }
+
+    [[nodiscard]] bool contains(const FoodId id) const noexcept {
+        return static_cast<size_t>(id) < size();
+    }
+
+    [[nodiscard]] std::string_view name(const FoodId id) const noexcept {
+        const auto index = static_cast<size_t>(id);
+        return { m_name_pool + m_name_offsets[index], m_name_offsets[index + 1] - m_name_offsets[index] - 1 };
+    }
+
+    [[nodiscard]] const char* c_name(const FoodId id) const noexcept {
+        return m_name_pool + m_name_offsets[static_cast<size_t>(id)];
+    }
+
+    // All names, null terminated and in id order: the name of food `i` starts at `name_pool() + name_offsets()[i]`
+    [[nodiscard]] const char* name_pool() const noexcept {
+        return m_name_pool;
+    }
+
+    [[nodiscard]] std::span<const uint32_t> name_offsets() const noexcept {
+        return m_name_offsets;
+    }
+
+    [[nodiscard]] const FoodProps& props(const FoodId id) const noexcept {
+        return m_props[static_cast<size_t>(id)];
+    }
+
+    [[nodiscard]] std::optional<FoodId> find_id(std::string_view name) const noexcept;
+    [[nodiscard]] const FoodProps* find(std::string_view name) const noexcept;
+
+private:
+    friend class FoodCatalogBuilder;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t food_count;
+        uint32_t bucket_count;
+        uint64_t name_pool_size;
+        uint64_t source_size;
+        int64_t source_last_write_time;
+        uint64_t checksum;
+    };
+
+    [[nodiscard]] static std::vector<std::byte> layout_image(
+        std::span<const FoodProps> props, std::span<const uint32_t> name_offsets, std::string_view name_pool);
+
+    // Points the catalog into either `owned_image` or `mapped_image`, whichever is not empty
+    bool assign_image(std::vector<std::byte> owned_image, MappedFile mapped_image);
+
+private:
+    std::vector<std::byte> m_owned_image;
+    MappedFile m_mapped_image;
+    std::span<const std::byte> m_image;
+
+    std::span<const FoodProps> m_props;
+    std::span<const uint32_t> m_name_offsets;
+
+    // Minimal perfect hash, built with the "hash, displace" method. The bucket of a name selects its displacement:
+    // negative displacements `d` place the name into the slot `-d - 1`, other ones are the seed to hash it with again.
+    // Every slot holds exactly one food.
+    std::span<const int32_t> m_displacements;
+    std::span<const uint32_t> m_slot_foods;
+    const char* m_name_pool = "";
+};
+
+
+// Accumulates foods, then lays them out into a `FoodCatalog` image
+class FoodCatalogBuilder {
+public:
+    void reserve(size_t food_count);
+    void add(std::string_view name, const FoodProps& props);
+
+    // Adds the foods of `other` after the ones already added, leaving `other` empty
+    void append(FoodCatalogBuilder&& other);
+
+    [[nodiscard]] FoodCatalog build() &&;
+
+private:
+    void remove_duplicates();
+
+private:
+    std::vector<FoodProps> m_props;
+    std::vector<uint32_t> m_name_offsets = { 0 };
+    std::string m_name_pool;
+};
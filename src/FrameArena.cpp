@@ -0,0 +1,57 @@
+#include "FrameArena.h"
+
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+
+
+namespace {
+
+// Aligns `offset` bytes into `buffer` up to `alignment`, which is a power of two
+size_t align_offset(const std::byte* buffer, const size_t offset, const size_t alignment) noexcept {
+    const auto address = reinterpret_cast<uintptr_t>(buffer) + offset;
+    return offset + ((alignment - address % alignment) % alignment);
+}
+
+} // namespace
+
+
+FrameArena::FrameArena(const size_t capacity)
+    : m_buffer(std::make_unique_for_overwrite<std::byte[]>(capacity))
+    , m_capacity(capacity) {}
+
+void FrameArena::reset() noexcept {
+    m_high_water_mark = std::max(m_high_water_mark, used());
+
+    // Grows once for the whole overflow, rather than chunk by chunk, so the arena ends up as one contiguous buffer
+    if (!m_overflow.empty()) {
+        const auto capacity = std::bit_ceil(m_capacity + m_overflow_size);
+        m_overflow.clear();
+        m_buffer.reset();
+        m_buffer   = std::make_unique_for_overwrite<std::byte[]>(capacity);
+        m_capacity = capacity;
+    }
+
+    m_offset        = 0;
+    m_overflow_size = 0;
+}
+
+void* FrameArena::do_allocate(const size_t bytes, const size_t alignment) {
+    const auto offset = align_offset(m_buffer.get(), m_offset, alignment);
+    if (offset + bytes <= m_capacity) {
+        m_offset = offset + bytes;
+        return m_buffer.get() + offset;
+    }
+
+    // Counts the padding as well, so that the grown arena surely fits the same allocations
+    auto& chunk = m_overflow.emplace_back(std::make_unique_for_overwrite<std::byte[]>(bytes + alignment));
+    m_overflow_size += bytes + alignment;
+    return chunk.get() + align_offset(chunk.get(), 0, alignment);
+}
+
+void FrameArena::do_deallocate(void* /*pointer*/, size_t /*bytes*/, size_t /*alignment*/) {}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <memory_resource>
+#include <fmt/format.h>
+
+
+// Bump allocator for whatever only lives until the end of a frame: allocating is bumping an offset, freeing does
+// nothing and `reset` frees everything at once. Hands out memory as a `std::pmr::memory_resource`, so that `std::pmr`
+// containers and strings can be built in it.
+//
+// A frame that needs more than the arena holds gets its overflow from the heap, and the next `reset` grows the arena
+// to fit it. After a few frames the arena is as big as the biggest frame and the frames stop touching the heap.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t default_capacity = size_t{ 256 } << 10;
+
+    explicit FrameArena(size_t capacity = default_capacity);
+
+    FrameArena(const FrameArena&)            = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Everything allocated since the last reset must not be used anymore
+    void reset() noexcept;
+
+    // Formats into a null terminated string in the arena, for the labels and tooltips that ImGui copies anyway
+    template <typename... Args>
+    [[nodiscard]] const char* format(fmt::format_string<Args...> format_string, Args&&... args) {
+        const auto size = fmt::formatted_size(format_string, args...);
+        auto* text      = static_cast<char*>(allocate(size + 1, alignof(char)));
+        *fmt::format_to(text, format_string, std::forward<Args>(args)...) = '\0';
+        return text;
+    }
+
+    [[nodiscard]] size_t used() const noexcept {
+        return m_offset + m_overflow_size;
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept {
+        return m_capacity;
+    }
+
+    // The most that any frame used so far
+    [[nodiscard]] size_t high_water_mark() const noexcept {
+        return m_high_water_mark;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    std::unique_ptr<std::byte[]> m_buffer;
+    size_t m_capacity = 0;
+    size_t m_offset   = 0;
+
+    std::vector<std::unique_ptr<std::byte[]>> m_overflow;
+    size_t m_overflow_size = 0;
+
+    size_t m_high_water_mark = 0;
+};
@@ -0,0 +1,379 @@
+#include "FuzzySearch.h"
+
+#include <array>
+#include <optional>
+#include <ranges>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include "MemoryStats.h"
+
+
+namespace {
+
+struct FoldRange {
+    char32_t first;
+    char32_t last;
+    std::string_view replacement;
+};
+
+// Both the upper and lower case forms fold to the same lower case replacement
+constexpr auto fold_ranges = std::array{
+    // Latin-1 Supplement
+    FoldRange{ 0x00C0, 0x00C5, "a" }, FoldRange{ 0x00C6, 0x00C6, "ae" }, FoldRange{ 0x00C7, 0x00C7, "c" },
+    FoldRange{ 0x00C8, 0x00CB, "e" }, FoldRange{ 0x00CC, 0x00CF, "i" }, FoldRange{ 0x00D0, 0x00D0, "d" },
+    FoldRange{ 0x00D1, 0x00D1, "n" }, FoldRange{ 0x00D2, 0x00D6, "o" }, FoldRange{ 0x00D8, 0x00D8, "o" },
+    FoldRange{ 0x00D9, 0x00DC, "u" }, FoldRange{ 0x00DD, 0x00DD, "y" }, FoldRange{ 0x00DE, 0x00DE, "th" },
+    FoldRange{ 0x00DF, 0x00DF, "ss" }, FoldRange{ 0x00E0, 0x00E5, "a" }, FoldRange{ 0x00E6, 0x00E6, "ae" },
+    FoldRange{ 0x00E7, 0x00E7, "c" }, FoldRange{ 0x00E8, 0x00EB, "e" }, FoldRange{ 0x00EC, 0x00EF, "i" },
+    FoldRange{ 0x00F0, 0x00F0, "d" }, FoldRange{ 0x00F1, 0x00F1, "n" }, FoldRange{ 0x00F2, 0x00F6, "o" },
+    FoldRange{ 0x00F8, 0x00F8, "o" }, FoldRange{ 0x00F9, 0x00FC, "u" }, FoldRange{ 0x00FD, 0x00FD, "y" },
+    FoldRange{ 0x00FE, 0x00FE, "th" }, FoldRange{ 0x00FF, 0x00FF, "y" },
+
+    // Latin Extended-A
+    FoldRange{ 0x0100, 0x0105, "a" }, FoldRange{ 0x0106, 0x010D, "c" }, FoldRange{ 0x010E, 0x0111, "d" },
+    FoldRange{ 0x0112, 0x011B, "e" }, FoldRange{ 0x011C, 0x0123, "g" }, FoldRange{ 0x0124, 0x0127, "h" },
+    FoldRange{ 0x0128, 0x0131, "i" }, FoldRange{ 0x0132, 0x0133, "ij" }, FoldRange{ 0x0134, 0x0135, "j" },
+    FoldRange{ 0x0136, 0x0138, "k" }, FoldRange{ 0x0139, 0x0142, "l" }, FoldRange{ 0x0143, 0x014B, "n" },
+    FoldRange{ 0x014C, 0x0151, "o" }, FoldRange{ 0x0152, 0x0153, "oe" }, FoldRange{ 0x0154, 0x0159, "r" },
+    FoldRange{ 0x015A, 0x0161, "s" }, FoldRange{ 0x0162, 0x0167, "t" }, FoldRange{ 0x0168, 0x0173, "u" },
+    FoldRange{ 0x0174, 0x0175, "w" }, FoldRange{ 0x0176, 0x0178, "y" }, FoldRange{ 0x0179, 0x017E, "z" },
+    FoldRange{ 0x017F, 0x017F, "s" },
+
+    // Romanian comma-below letters from Latin Extended-B
+    FoldRange{ 0x0218, 0x0219, "s" }, FoldRange{ 0x021A, 0x021B, "t" },
+};
+
+std::string_view fold_codepoint(const char32_t codepoint) {
+    const auto it = std::ranges::find_if(fold_ranges, [&](const FoldRange& range) {
+        return codepoint >= range.first && codepoint <= range.last;
+    });
+    return (it != fold_ranges.end()) ? it->replacement : std::string_view{};
+}
+
+constexpr bool is_ascii_alnum(const char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+constexpr bool is_ascii_space(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+constexpr uint32_t trigram_key(const std::string_view text) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(text[0])) << 16) |
+        (static_cast<uint32_t>(static_cast<unsigned char>(text[1])) << 8) |
+        static_cast<uint32_t>(static_cast<unsigned char>(text[2]));
+}
+
+// Scoring constants loosely follow fzf's v1 algorithm
+constexpr int score_match           = 16;
+constexpr int bonus_word_start      = 16;
+constexpr int bonus_name_prefix     = 24;
+constexpr int bonus_exact_match     = 64;
+constexpr int max_leading_penalty   = 15;
+constexpr int max_unmatched_penalty = 16;
+
+bool is_word_start(const std::string_view name, const size_t pos) {
+    return pos == 0 || !is_ascii_alnum(name[pos - 1]);
+}
+
+std::optional<int> score_name(const std::string_view name, const std::vector<std::string_view>& terms) {
+    auto score          = 0;
+    auto matched_length = size_t{ 0 };
+
+    for (const auto term : terms) {
+        const auto first = name.find(term);
+        if (first == std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        // Prefer an occurrence at the start of a word over the leftmost one
+        auto pos = first;
+        while (!is_word_start(name, pos)) {
+            pos = name.find(term, pos + 1);
+            if (pos == std::string_view::npos) {
+                pos = first;
+                break;
+            }
+        }
+
+        score += score_match * static_cast<int>(term.size());
+        score += is_word_start(name, pos) ? bonus_word_start : 0;
+        score -= std::min(static_cast<int>(pos), max_leading_penalty);
+        matched_length += term.size();
+    }
+
+    if (terms.size() == 1 && name == terms.front()) {
+        score += bonus_exact_match;
+    } else if (name.starts_with(terms.front())) {
+        score += bonus_name_prefix;
+    }
+
+    const auto unmatched_length = name.size() - std::min(matched_length, name.size());
+    score -= std::min(static_cast<int>(unmatched_length / 4), max_unmatched_penalty);
+    return score;
+}
+
+std::vector<std::string_view> split_terms(const std::string_view folded_query) {
+    auto terms = std::vector<std::string_view>{};
+
+    for (size_t pos = 0; pos < folded_query.size();) {
+        if (is_ascii_space(folded_query[pos])) {
+            pos += 1;
+            continue;
+        }
+
+        auto end = pos;
+        while (end < folded_query.size() && !is_ascii_space(folded_query[end])) {
+            end += 1;
+        }
+        terms.push_back(folded_query.substr(pos, end - pos));
+        pos = end;
+    }
+
+    return terms;
+}
+
+// Ordering used for the result heap, "less" means "ranked higher"
+bool is_better_match(const FuzzySearchIndex::Match& lhs, const FuzzySearchIndex::Match& rhs) {
+    return (lhs.score != rhs.score) ? (lhs.score > rhs.score) : (lhs.index < rhs.index);
+}
+
+} // namespace
+
+
+std::string fold_search_text(const std::string_view text) {
+    auto result = std::string{};
+    result.reserve(text.size());
+
+    for (size_t pos = 0; pos < text.size();) {
+        const auto byte = static_cast<unsigned char>(text[pos]);
+        if (byte < 0x80) {
+            result += (byte >= 'A' && byte <= 'Z') ? static_cast<char>(byte - 'A' + 'a') : static_cast<char>(byte);
+            pos += 1;
+            continue;
+        }
+
+        // All of the letters we fold are encoded as 2 byte UTF-8 sequences, everything else is copied verbatim
+        const auto next = (pos + 1 < text.size()) ? static_cast<unsigned char>(text[pos + 1]) : 0u;
+        if ((byte & 0xE0u) == 0xC0u && (next & 0xC0u) == 0x80u) {
+            const auto codepoint   = static_cast<char32_t>(((byte & 0x1Fu) << 6) | (next & 0x3Fu));
+            const auto replacement = fold_codepoint(codepoint);
+            result += replacement.empty() ? text.substr(pos, 2) : replacement;
+            pos += 2;
+            continue;
+        }
+
+        result += text[pos];
+        pos += 1;
+    }
+
+    return result;
+}
+
+FuzzySearchIndex::FuzzySearchIndex(const std::span<const std::string_view> items) {
+    MEMORY_TAG(Search);
+
+    m_offsets.reserve(items.size() + 1);
+    m_offsets.push_back(0);
+
+    for (const auto item : items) {
+        m_folded_pool += fold_search_text(item);
+        m_offsets.push_back(static_cast<uint32_t>(m_folded_pool.size()));
+    }
+
+    // Every (trigram, item) pair packed into one integer so that a single sort groups the posting lists together
+    auto pairs = std::vector<uint64_t>{};
+    pairs.reserve(m_folded_pool.size());
+
+    for (uint32_t index = 0; index < size(); ++index) {
+        const auto name = folded_name(index);
+        for (size_t pos = 0; pos + 3 <= name.size(); ++pos) {
+            const auto trigram = name.substr(pos, 3);
+
+            // Query terms never contain whitespace, so neither do the trigrams worth indexing
+            if (std::ranges::any_of(trigram, is_ascii_space)) {
+                continue;
+            }
+            pairs.push_back((static_cast<uint64_t>(trigram_key(trigram)) << 32) | index);
+        }
+    }
+
+    std::ranges::sort(pairs);
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    m_postings.reserve(pairs.size());
+    for (const auto pair : pairs) {
+        const auto trigram = static_cast<uint32_t>(pair >> 32);
+        if (m_trigrams.empty() || m_trigrams.back() != trigram) {
+            m_trigrams.push_back(trigram);
+            m_posting_offsets.push_back(static_cast<uint32_t>(m_postings.size()));
+        }
+        m_postings.push_back(static_cast<uint32_t>(pair));
+    }
+    m_posting_offsets.push_back(static_cast<uint32_t>(m_postings.size()));
+}
+
+std::string_view FuzzySearchIndex::folded_name(const uint32_t index) const noexcept {
+    return std::string_view{ m_folded_pool }.substr(m_offsets[index], m_offsets[index + 1] - m_offsets[index]);
+}
+
+void FuzzySearchIndex::find_candidates(const std::vector<std::string_view>& terms, std::vector<uint32_t>& candidates) const {
+    struct PostingList {
+        const uint32_t* begin;
+        const uint32_t* end;
+    };
+
+    auto posting_lists = std::vector<PostingList>{};
+    for (const auto term : terms) {
+        for (size_t pos = 0; pos + 3 <= term.size(); ++pos) {
+            const auto trigram = trigram_key(term.substr(pos, 3));
+            const auto it      = std::ranges::lower_bound(m_trigrams, trigram);
+
+            // No item contains this trigram, so no item can contain the term either
+            if (it == m_trigrams.end() || *it != trigram) {
+                candidates.clear();
+                return;
+            }
+
+            const auto list_index = static_cast<size_t>(it - m_trigrams.begin());
+            posting_lists.push_back({ m_postings.data() + m_posting_offsets[list_index],
+                m_postings.data() + m_posting_offsets[list_index + 1] });
+        }
+    }
+
+    // Terms shorter than a trigram can't narrow down anything, so every item has to be checked
+    if (posting_lists.empty()) {
+        candidates.resize(size());
+        for (uint32_t index = 0; index < size(); ++index) {
+            candidates[index] = index;
+        }
+        return;
+    }
+
+    // Intersecting the shortest lists first keeps the intermediate results as small as possible
+    std::ranges::sort(posting_lists, std::less{}, [](const PostingList& list) { return list.end - list.begin; });
+
+    candidates.assign(posting_lists.front().begin, posting_lists.front().end);
+    auto intersection = std::vector<uint32_t>{};
+
+    for (const auto& list : posting_lists | std::views::drop(1)) {
+        if (candidates.empty()) {
+            return;
+        }
+
+        intersection.clear();
+        std::set_intersection(candidates.begin(), candidates.end(), list.begin, list.end, std::back_inserter(intersection));
+        candidates.swap(intersection);
+    }
+}
+
+void FuzzySearchIndex::search(const std::string_view query, std::vector<Match>& matches, const size_t max_results) const {
+    MEMORY_TAG(Search);
+
+    auto all_matches = std::vector<Match>{};
+    filter(query, all_matches);
+    rank(all_matches, matches, max_results);
+}
+
+void FuzzySearchIndex::filter(const std::string_view query, std::vector<Match>& matches) const {
+    matches.clear();
+
+    const auto folded_query = fold_search_text(query);
+    const auto terms        = split_terms(folded_query);
+
+    if (terms.empty()) {
+        matches.reserve(size());
+        for (size_t index = 0; index < size(); ++index) {
+            matches.push_back({ .index = static_cast<int>(index), .score = 0 });
+        }
+        return;
+    }
+
+    auto candidates = std::vector<uint32_t>{};
+    find_candidates(terms, candidates);
+
+    for (const auto index : candidates) {
+        if (const auto score = score_name(folded_name(index), terms); score.has_value()) {
+            matches.push_back({ .index = static_cast<int>(index), .score = *score });
+        }
+    }
+}
+
+void FuzzySearchIndex::filter(
+    const std::string_view query, const std::vector<Match>& candidates, std::vector<Match>& matches) const {
+    matches.clear();
+
+    const auto folded_query = fold_search_text(query);
+    const auto terms        = split_terms(folded_query);
+
+    if (terms.empty()) {
+        matches.assign(candidates.begin(), candidates.end());
+        return;
+    }
+
+    for (const auto& candidate : candidates) {
+        const auto score = score_name(folded_name(static_cast<uint32_t>(candidate.index)), terms);
+        if (score.has_value()) {
+            matches.push_back({ .index = candidate.index, .score = *score });
+        }
+    }
+}
+
+void FuzzySearchIndex::rank(const std::vector<Match>& matches, std::vector<Match>& ranked, const size_t max_results) {
+    ranked.clear();
+    if (max_results == 0) {
+        return;
+    }
+
+    // Keep the best `max_results` matches in a heap whose front is the worst of them
+    for (const auto& match : matches) {
+        if (ranked.size() < max_results) {
+            ranked.push_back(match);
+            std::ranges::push_heap(ranked, is_better_match);
+        } else if (is_better_match(match, ranked.front())) {
+            std::ranges::pop_heap(ranked, is_better_match);
+            ranked.back() = match;
+            std::ranges::push_heap(ranked, is_better_match);
+        }
+    }
+
+    std::ranges::sort_heap(ranked, is_better_match);
+}
+
+const std::vector<int>& FuzzySearchCache::search(
+    const FuzzySearchIndex& index, const std::string_view query, const size_t max_results) {
+    MEMORY_TAG(Search);
+
+    const auto is_same_index = (m_index == &index);
+    if (is_same_index && query == m_query && max_results == m_max_results) {
+        return m_ranked_indices;
+    }
+
+    // Narrowing down only pays off when the previous query actually filtered something out
+    const auto has_terms = [](const std::string_view text) {
+        return std::ranges::any_of(text, [](const char c) { return !is_ascii_space(c); });
+    };
+
+    // When only `max_results` changed, the matches can be ranked again as they are
+    if (!is_same_index || query != m_query) {
+        if (is_same_index && query.starts_with(m_query) && has_terms(m_query)) {
+            index.filter(query, m_matches, m_narrowed_matches);
+            m_matches.swap(m_narrowed_matches);
+        } else {
+            index.filter(query, m_matches);
+        }
+    }
+
+    FuzzySearchIndex::rank(m_matches, m_ranked, max_results);
+
+    m_ranked_indices.clear();
+    for (const auto& match : m_ranked) {
+        m_ranked_indices.push_back(match.index);
+    }
+
+    m_index = &index;
+    m_query.assign(query);
+    m_max_results = max_results;
+    return m_ranked_indices;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+
+// Lower-cases ASCII and replaces the latin letters with diacritics that our font can render (Latin-1 Supplement,
+// Latin Extended-A and the Romanian comma-below letters) with their base letters, so that "Căpșuni" matches "capsuni".
+[[nodiscard]] std::string fold_search_text(std::string_view text);
+
+
+// Prebuilt search index over a fixed list of names. Every name is folded once and a trigram index is built over the
+// folded names, so a query only has to look at the items that contain all of its trigrams instead of the whole list.
+//
+// A query is split on whitespace into terms and an item matches when it contains every term. The matches are then
+// ranked fzf-style: matches at the start of the name or of a word, exact matches and short names score higher.
+class FuzzySearchIndex {
+public:
+    struct Match {
+        int index = -1;
+        int score = 0;
+    };
+
+    FuzzySearchIndex() = default;
+    explicit FuzzySearchIndex(std::span<const std::string_view> items);
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+    }
+
+    // Fills `matches` with the best `max_results` items for `query`, best match first. An empty query matches every
+    // item, in the order in which they were indexed.
+    void search(std::string_view query, std::vector<Match>& matches, size_t max_results) const;
+
+    // Fills `matches` with every item matching `query`, unranked. The second overload only considers the items in
+    // `candidates`, which is enough when `query` extends the query that `candidates` were matched against, since an
+    // item can't match the longer query without matching the shorter one.
+    void filter(std::string_view query, std::vector<Match>& matches) const;
+    void filter(std::string_view query, const std::vector<Match>& candidates, std::vector<Match>& matches) const;
+
+    // Fills `ranked` with the best `max_results` of `matches`, best match first
+    static void rank(const std::vector<Match>& matches, std::vector<Match>& ranked, size_t max_results);
+
+private:
+    [[nodiscard]] std::string_view folded_name(uint32_t index) const noexcept;
+    void find_candidates(const std::vector<std::string_view>& terms, std::vector<uint32_t>& candidates) const;
+
+private:
+    std::string m_folded_pool;
+    std::vector<uint32_t> m_offsets;
+
+    // Compressed posting lists: the items containing `m_trigrams[i]` are
+    // `m_postings[m_posting_offsets[i] .. m_posting_offsets[i + 1]]`, in ascending order.
+    std::vector<uint32_t> m_trigrams;
+    std::vector<uint32_t> m_posting_offsets;
+    std::vector<uint32_t> m_postings;
+};
+
+
+// Memoizes the results of the last query made against an index. Asking again for the same query is free, and when the
+// query only had characters appended to it, only the previous matches are filtered instead of the whole index. This
+// makes typing cost proportional to the number of matches rather than to the number of items.
+class FuzzySearchCache {
+public:
+    // Returns the item indices of the best `max_results` matches for `query`, best match first. The result stays
+    // valid until the next call.
+    const std::vector<int>& search(const FuzzySearchIndex& index, std::string_view query, size_t max_results);
+
+    // Has to be called whenever the items of the index change
+    void invalidate() noexcept {
+        m_index = nullptr;
+    }
+
+private:
+    const FuzzySearchIndex* m_index = nullptr;
+    std::string m_query;
+    size_t m_max_results = 0;
+
+    std::vector<FuzzySearchIndex::Match> m_matches;
+    std::vector<FuzzySearchIndex::Match> m_narrowed_matches;
+    std::vector<FuzzySearchIndex::Match> m_ranked;
+    std::vector<int> m_ranked_indices;
+};
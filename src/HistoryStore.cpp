@@ -0,0 +1,561 @@
+#include "HistoryStore.h"
+
+#include <ctime>
+#include <cstring>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include "BinaryIO.h"
+#include "AtomicFile.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+
+
+std::chrono::sys_days today() {
+    const auto now = std::time(nullptr);
+    auto local     = std::tm{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    return std::chrono::year{ local.tm_year + 1900 } / std::chrono::month{ static_cast<unsigned>(local.tm_mon + 1) } /
+        std::chrono::day{ static_cast<unsigned>(local.tm_mday) };
+}
+
+std::string format_day(const std::chrono::sys_days day) {
+    const auto date = std::chrono::year_month_day{ day };
+    return fmt::format("{:04}-{:02}-{:02}", static_cast<int>(date.year()), static_cast<unsigned>(date.month()),
+        static_cast<unsigned>(date.day()));
+}
+
+std::optional<std::chrono::sys_days> parse_day(const std::string_view text) {
+    auto year  = 0;
+    auto month = 0u;
+    auto day   = 0u;
+
+    // Parses one number of the date, followed by either a dash or the end of the text
+    auto rest             = text;
+    const auto parse_part = [&](auto& value, const bool is_last) {
+        const auto [part_end, error] = std::from_chars(rest.data(), rest.data() + rest.size(), value);
+        if (error != std::errc{}) {
+            return false;
+        }
+
+        rest.remove_prefix(static_cast<size_t>(part_end - rest.data()));
+        if (is_last) {
+            return rest.empty();
+        }
+        if (rest.empty() || rest.front() != '-') {
+            return false;
+        }
+        rest.remove_prefix(1);
+        return true;
+    };
+
+    if (!parse_part(year, false) || !parse_part(month, false) || !parse_part(day, true)) {
+        return std::nullopt;
+    }
+
+    const auto date = std::chrono::year{ year } / std::chrono::month{ month } / std::chrono::day{ day };
+    return date.ok() ? std::optional{ std::chrono::sys_days{ date } } : std::nullopt;
+}
+
+void HistoryTotals::clear() noexcept {
+    keys.clear();
+    for (auto& column : columns) {
+        column.clear();
+    }
+}
+
+
+namespace {
+
+constexpr size_t column_count = std::tuple_size_v<decltype(HistoryTotals::columns)>;
+
+int32_t day_number(const std::chrono::sys_days day) noexcept {
+    return static_cast<int32_t>(day.time_since_epoch().count());
+}
+
+std::chrono::sys_days day_from_number(const int32_t number) noexcept {
+    return std::chrono::sys_days{ std::chrono::days{ number } };
+}
+
+// Months are numbered from year 0, so that they sort chronologically
+int32_t month_of(const std::chrono::sys_days day) noexcept {
+    const auto date = std::chrono::year_month_day{ day };
+    return static_cast<int32_t>(date.year()) * 12 + static_cast<int32_t>(static_cast<unsigned>(date.month())) - 1;
+}
+
+struct IndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t chunk_count;
+    uint32_t reserved;
+};
+
+// The header is followed by the columns `int32_t days[]`, `uint32_t meals[]`, one `float totals[]` per nutrient and
+// `uint32_t detail_offsets[meal_count + 1]`, then the details of every meal
+struct ChunkHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t meal_count;
+    uint32_t details_size;
+};
+
+// A memory mapped chunk. Nothing gets read from the file until a column is accessed.
+class ChunkView {
+public:
+    [[nodiscard]] static std::optional<ChunkView> open(const std::filesystem::path& path) {
+        auto file = MappedFile{ path };
+        if (!file.is_open()) {
+            return std::nullopt;
+        }
+
+        const auto bytes = file.bytes();
+        auto header      = ChunkHeader{};
+        if (bytes.size() < sizeof(header)) {
+            return invalid(path);
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        const auto count         = size_t{ header.meal_count };
+        const auto row_size      = sizeof(int32_t) + sizeof(uint32_t) + column_count * sizeof(float);
+        const auto expected_size = sizeof(header) + count * row_size + (count + 1) * sizeof(uint32_t) + header.details_size;
+
+        if (header.magic != HistoryStore::chunk_magic || header.version != HistoryStore::file_version ||
+            bytes.size() != expected_size) {
+            return invalid(path);
+        }
+
+        auto chunk      = ChunkView{};
+        const auto* data = bytes.data() + sizeof(header);
+
+        chunk.days = { reinterpret_cast<const int32_t*>(data), count };
+        data += count * sizeof(int32_t);
+        chunk.meals = { reinterpret_cast<const uint32_t*>(data), count };
+        data += count * sizeof(uint32_t);
+        for (auto& column : chunk.totals) {
+            column = { reinterpret_cast<const float*>(data), count };
+            data += count * sizeof(float);
+        }
+        chunk.detail_offsets = { reinterpret_cast<const uint32_t*>(data), count + 1 };
+        data += (count + 1) * sizeof(uint32_t);
+        chunk.details = { reinterpret_cast<const char*>(data), header.details_size };
+
+        const auto has_valid_offsets = std::ranges::is_sorted(chunk.detail_offsets) &&
+            chunk.detail_offsets.front() == 0 && chunk.detail_offsets.back() == header.details_size;
+        if (!has_valid_offsets) {
+            return invalid(path);
+        }
+
+        chunk.m_file = std::move(file);
+        return chunk;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return days.size();
+    }
+
+    [[nodiscard]] MealKey key(const size_t index) const noexcept {
+        return { .day = day_from_number(days[index]), .meal = meals[index] };
+    }
+
+    [[nodiscard]] std::string_view details_of(const size_t index) const noexcept {
+        return details.substr(detail_offsets[index], detail_offsets[index + 1] - detail_offsets[index]);
+    }
+
+    // Range of the meals eaten from `first` to `last`, both inclusive
+    [[nodiscard]] std::pair<size_t, size_t> find_days(const int32_t first, const int32_t last) const {
+        const auto begin = std::ranges::lower_bound(days, first) - days.begin();
+        const auto end   = std::ranges::upper_bound(days, last) - days.begin();
+        return { static_cast<size_t>(begin), static_cast<size_t>(std::max(begin, end)) };
+    }
+
+public:
+    std::span<const int32_t> days;
+    std::span<const uint32_t> meals;
+    std::array<std::span<const float>, column_count> totals;
+    std::span<const uint32_t> detail_offsets;
+    std::string_view details;
+
+private:
+    static std::optional<ChunkView> invalid(const std::filesystem::path& path) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: The history chunk {} is corrupt, ignoring it\n", path);
+        return std::nullopt;
+    }
+
+private:
+    MappedFile m_file;
+};
+
+struct StoredMeal {
+    MealKey key;
+    std::array<float, column_count> totals;
+    std::string details;
+};
+
+std::string encode_chunk(const std::vector<StoredMeal>& meals) {
+    auto out = std::string{};
+
+    auto details_size = size_t{ 0 };
+    for (const auto& meal : meals) {
+        details_size += meal.details.size();
+    }
+
+    binary::put(out, ChunkHeader{
+        .magic        = HistoryStore::chunk_magic,
+        .version      = HistoryStore::file_version,
+        .meal_count   = static_cast<uint32_t>(meals.size()),
+        .details_size = static_cast<uint32_t>(details_size),
+    });
+
+    for (const auto& meal : meals) {
+        binary::put(out, day_number(meal.key.day));
+    }
+    for (const auto& meal : meals) {
+        binary::put(out, meal.key.meal);
+    }
+    for (size_t column = 0; column < column_count; ++column) {
+        for (const auto& meal : meals) {
+            binary::put(out, meal.totals[column]);
+        }
+    }
+
+    auto offset = uint32_t{ 0 };
+    binary::put(out, offset);
+    for (const auto& meal : meals) {
+        offset += static_cast<uint32_t>(meal.details.size());
+        binary::put(out, offset);
+    }
+
+    for (const auto& meal : meals) {
+        out += meal.details;
+    }
+    return out;
+}
+
+void encode_details(const MealSnapshot& meal, const FoodCatalog& food_catalog, std::string& out) {
+    binary::put_string(out, meal.title);
+    binary::put_string(out, meal.notes);
+    binary::put(out, static_cast<uint32_t>(meal.rows.size()));
+    for (const auto& row : meal.rows) {
+        write_food(out, row, food_catalog);
+    }
+}
+
+std::optional<MealSnapshot> decode_details(const std::string_view details, const FoodCatalog& food_catalog) {
+    auto reader = binary::Reader{ details };
+    auto meal   = MealSnapshot{
+          .title = std::string{ reader.get_string() },
+          .notes = std::string{ reader.get_string() },
+    };
+
+    const auto row_count = reader.get<uint32_t>();
+    for (uint32_t index = 0; index < row_count && !reader.failed(); ++index) {
+        meal.rows.push_back(read_food(reader, food_catalog));
+    }
+
+    if (reader.failed()) {
+        return std::nullopt;
+    }
+
+    const auto unknown_foods = std::erase_if(meal.rows, [](const Food& row) { return row.id == FoodId::Invalid; });
+    if (unknown_foods != 0) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: {} foods of the meal are not in the catalog, skipping them\n",
+            unknown_foods);
+    }
+    return meal;
+}
+
+} // namespace
+
+
+HistoryStore::HistoryStore(std::filesystem::path directory)
+    : m_directory(std::move(directory)) {
+    read_index();
+    recover_chunks();
+}
+
+void HistoryStore::read_index() {
+    auto file = std::ifstream{ m_directory / "index.bin", std::ios::binary };
+    if (!file) {
+        return;
+    }
+
+    const auto bytes = std::string{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    auto reader      = binary::Reader{ bytes };
+    const auto header = reader.get<IndexHeader>();
+
+    if (reader.failed() || header.magic != index_magic || header.version != file_version ||
+        reader.remaining() != header.chunk_count * sizeof(ChunkEntry)) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: The history index in {} is corrupt\n", m_directory);
+        return;
+    }
+
+    m_chunks.reserve(header.chunk_count);
+    for (uint32_t index = 0; index < header.chunk_count; ++index) {
+        m_chunks.push_back(reader.get<ChunkEntry>());
+    }
+    std::ranges::sort(m_chunks, {}, &ChunkEntry::month);
+}
+
+std::optional<std::pair<std::chrono::sys_days, std::chrono::sys_days>> HistoryStore::date_range() const {
+    const auto lock = std::scoped_lock{ m_mutex };
+    if (m_chunks.empty()) {
+        return std::nullopt;
+    }
+    return std::pair{ day_from_number(m_chunks.front().first_day), day_from_number(m_chunks.back().last_day) };
+}
+
+void HistoryStore::load_totals(const std::chrono::sys_days first, const std::chrono::sys_days last,
+    const std::span<const size_t> columns, HistoryTotals& totals) const {
+    PROFILE_FUNCTION();
+
+    totals.clear();
+
+    auto months = std::vector<int32_t>{};
+    {
+        const auto lock  = std::scoped_lock{ m_mutex };
+        const auto begin = std::ranges::lower_bound(m_chunks, month_of(first), {}, &ChunkEntry::month);
+        const auto end   = std::ranges::upper_bound(m_chunks, month_of(last), {}, &ChunkEntry::month);
+
+        for (auto entry = begin; entry < end; ++entry) {
+            months.push_back(entry->month);
+        }
+    }
+
+    for (const auto month : months) {
+        const auto chunk = ChunkView::open(chunk_path(month));
+        if (!chunk.has_value()) {
+            continue;
+        }
+
+        const auto [begin, end] = chunk->find_days(day_number(first), day_number(last));
+        for (auto index = begin; index < end; ++index) {
+            totals.keys.push_back(chunk->key(index));
+        }
+
+        for (const auto column : columns) {
+            const auto values = chunk->totals[column].subspan(begin, end - begin);
+            totals.columns[column].insert(totals.columns[column].end(), values.begin(), values.end());
+        }
+    }
+}
+
+RangeTotals HistoryStore::range_totals(const std::chrono::sys_days first, const std::chrono::sys_days last) const {
+    {
+        const auto lock = std::scoped_lock{ m_mutex };
+        if (m_has_rollup) {
+            return m_rollup.query(first, last);
+        }
+    }
+
+    // The rollup gets built from the chunk files, so no save may replace one of them meanwhile
+    const auto lock = std::scoped_lock{ m_write_mutex, m_mutex };
+    if (!m_has_rollup) {
+        build_rollup();
+    }
+    return m_rollup.query(first, last);
+}
+
+std::optional<MealSnapshot> HistoryStore::load_meal(const MealKey& key, const FoodCatalog& food_catalog) const {
+    PROFILE_FUNCTION();
+
+    const auto chunk = ChunkView::open(chunk_path(month_of(key.day)));
+    if (!chunk.has_value()) {
+        return std::nullopt;
+    }
+
+    const auto [begin, end] = chunk->find_days(day_number(key.day), day_number(key.day));
+    for (auto index = begin; index < end; ++index) {
+        if (chunk->meals[index] == key.meal) {
+            return decode_details(chunk->details_of(index), food_catalog);
+        }
+    }
+    return std::nullopt;
+}
+
+bool HistoryStore::store_meal(const MealKey& key, const MealSnapshot& meal, const FoodCatalog& food_catalog) {
+    PROFILE_FUNCTION();
+
+    auto stored = StoredMeal{ .key = key, .totals = {}, .details = {} };
+    encode_details(meal, food_catalog, stored.details);
+
+    for (size_t column = 0; column < column_count; ++column) {
+        auto total = 0.0;
+        for (const auto& row : meal.rows) {
+            total += static_cast<double>(row.values[column]);
+        }
+        stored.totals[column] = static_cast<float>(total);
+    }
+
+    const auto month      = month_of(key.day);
+    const auto write_lock = std::scoped_lock{ m_write_mutex };
+
+    // The chunk is rewritten as a whole, it only holds a month worth of meals. It has to be unmapped before it can be
+    // replaced on Windows.
+    auto meals = std::vector<StoredMeal>{};
+    if (const auto chunk = ChunkView::open(chunk_path(month)); chunk.has_value()) {
+        meals.reserve(chunk->size() + 1);
+        for (size_t index = 0; index < chunk->size(); ++index) {
+            auto& other = meals.emplace_back(chunk->key(index), std::array<float, column_count>{},
+                std::string{ chunk->details_of(index) });
+
+            for (size_t column = 0; column < column_count; ++column) {
+                other.totals[column] = chunk->totals[column][index];
+            }
+        }
+    }
+
+    // Only the difference to the meal being replaced goes into the rollup
+    auto rollup_delta = DailyRollup::Totals{};
+    for (size_t column = 0; column < column_count; ++column) {
+        rollup_delta[column] = static_cast<double>(stored.totals[column]);
+    }
+
+    const auto position    = std::ranges::lower_bound(meals, key, {}, &StoredMeal::key);
+    const auto is_replaced = position != meals.end() && position->key == key;
+    if (is_replaced) {
+        for (size_t column = 0; column < column_count; ++column) {
+            rollup_delta[column] -= static_cast<double>(position->totals[column]);
+        }
+        *position = std::move(stored);
+    } else {
+        meals.insert(position, std::move(stored));
+    }
+
+    auto error = std::error_code{};
+    std::filesystem::create_directories(m_directory, error);
+    if (!atomic_write_file(chunk_path(month), encode_chunk(meals))) {
+        return false;
+    }
+
+    const auto entry = ChunkEntry{
+        .month      = month,
+        .meal_count = static_cast<uint32_t>(meals.size()),
+        .first_day  = day_number(meals.front().key.day),
+        .last_day   = day_number(meals.back().key.day),
+    };
+
+    // Once the chunk is replaced the meal is stored, whether or not the index gets written. The index only caches the
+    // entries of the chunks, should writing it fail the next launch finds the chunk newer than the index and recovers it.
+    {
+        const auto lock        = std::scoped_lock{ m_mutex };
+        const auto chunk_entry = std::ranges::lower_bound(m_chunks, month, {}, &ChunkEntry::month);
+        if (chunk_entry != m_chunks.end() && chunk_entry->month == month) {
+            *chunk_entry = entry;
+        } else {
+            m_chunks.insert(chunk_entry, entry);
+        }
+
+        if (m_has_rollup) {
+            m_rollup.add(key.day, rollup_delta, is_replaced ? 0 : 1);
+        }
+        m_revision.fetch_add(1, std::memory_order_release);
+    }
+
+    // Only saves change the chunks, and they are held off by `m_write_mutex`
+    static_cast<void>(write_index(m_chunks));
+    return true;
+}
+
+std::filesystem::path HistoryStore::chunk_path(const int32_t month) const {
+    return m_directory / fmt::format("{:04}-{:02}.chunk", month / 12, month % 12 + 1);
+}
+
+// Chunks get written before the index, so a save that failed in between leaves a chunk that the index is missing or
+// out of date about. Every chunk written after the index gets its entry read from the chunk itself.
+void HistoryStore::recover_chunks() {
+    auto error            = std::error_code{};
+    const auto index_time = std::filesystem::last_write_time(m_directory / "index.bin", error);
+    const auto has_index  = !error;
+
+    auto recovered_count = size_t{ 0 };
+    for (auto it = std::filesystem::directory_iterator{ m_directory, error };
+         !error && it != std::filesystem::directory_iterator{}; it.increment(error)) {
+        // Chunks are named after their month, "2023-06.chunk"
+        const auto& path = it->path();
+        const auto day   = parse_day(path.stem().string() + "-01");
+        if (path.extension() != ".chunk" || !day.has_value()) {
+            continue;
+        }
+
+        const auto month      = month_of(*day);
+        const auto entry      = std::ranges::lower_bound(m_chunks, month, {}, &ChunkEntry::month);
+        const auto is_indexed = entry != m_chunks.end() && entry->month == month;
+
+        auto time_error = std::error_code{};
+        if (is_indexed && has_index && it->last_write_time(time_error) <= index_time && !time_error) {
+            continue;
+        }
+
+        const auto chunk = ChunkView::open(path);
+        if (!chunk.has_value() || chunk->size() == 0) {
+            continue;
+        }
+
+        const auto recovered = ChunkEntry{
+            .month      = month,
+            .meal_count = static_cast<uint32_t>(chunk->size()),
+            .first_day  = chunk->days.front(),
+            .last_day   = chunk->days.back(),
+        };
+        if (!is_indexed) {
+            m_chunks.insert(entry, recovered);
+        } else if (*entry != recovered) {
+            *entry = recovered;
+        } else {
+            continue;
+        }
+        recovered_count += 1;
+    }
+
+    if (recovered_count != 0) {
+        fmt::print(stderr, fmt::fg(fmt::color::yellow),
+            "[WARNING]: Recovered {} months of history that were missing from the index in {}\n", recovered_count,
+            m_directory);
+        static_cast<void>(write_index(m_chunks));
+    }
+}
+
+bool HistoryStore::write_index(const std::span<const ChunkEntry> chunks) const {
+    auto out = std::string{};
+    binary::put(out, IndexHeader{
+        .magic       = index_magic,
+        .version     = file_version,
+        .chunk_count = static_cast<uint32_t>(chunks.size()),
+        .reserved    = 0,
+    });
+
+    for (const auto& entry : chunks) {
+        binary::put(out, entry);
+    }
+    return atomic_write_file(m_directory / "index.bin", out);
+}
+
+void HistoryStore::build_rollup() const {
+    PROFILE_FUNCTION();
+
+    // Only the totals columns of the chunks get read, never the details of the meals
+    m_rollup.clear();
+    for (const auto& entry : m_chunks) {
+        const auto chunk = ChunkView::open(chunk_path(entry.month));
+        if (!chunk.has_value()) {
+            continue;
+        }
+
+        for (size_t index = 0; index < chunk->size(); ++index) {
+            auto totals = DailyRollup::Totals{};
+            for (size_t column = 0; column < column_count; ++column) {
+                totals[column] = static_cast<double>(chunk->totals[column][index]);
+            }
+            m_rollup.add(chunk->key(index).day, totals, 1);
+        }
+    }
+    m_has_rollup = true;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <span>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <filesystem>
+#include <string_view>
+#include "Meal.h"
+#include "DailyRollup.h"
+#include "FoodCatalog.h"
+
+
+// The current day in the local time zone
+[[nodiscard]] std::chrono::sys_days today();
+
+// ISO 8601 dates, "2023-06-30"
+[[nodiscard]] std::string format_day(std::chrono::sys_days day);
+[[nodiscard]] std::optional<std::chrono::sys_days> parse_day(std::string_view text);
+
+
+// Identifies a meal of the history: the day it was eaten on and its index among the meals of that day
+struct MealKey {
+    std::chrono::sys_days day = {};
+    uint32_t meal             = 0;
+
+    auto operator<=>(const MealKey&) const = default;
+};
+
+
+// Totals of the meals in a date range, one entry per meal in chronological order, stored column-wise. Only the
+// requested nutrient columns get filled.
+struct HistoryTotals {
+    std::vector<MealKey> keys                 = {};
+    std::array<std::vector<float>, 5> columns = {};
+
+    void clear() noexcept;
+};
+
+
+// Every meal ever saved, on disk as one chunk file per month plus an index of the months.
+//
+// Chunks are columnar: the days, meal indices and every nutrient total of their meals are each stored as one
+// contiguous array, followed by the details (title, notes and foods) of every meal. Loading a date range for a graph
+// maps only the chunks of the months in the range and only touches the columns that it needs, so both the time and the
+// memory it takes are proportional to the range rather than to the whole history. Opening the history reads the index,
+// a few bytes per month, and lists the chunk files, to recover the months that a save failed to add to the index.
+//
+// Sums and averages over a date range don't even need the chunks of the range: they come out of a rollup of the
+// totals of every day, which is built from the totals columns on the first such query and kept up to date by every
+// meal stored after.
+//
+// The store can be used from several threads at once. Saves are serialized among themselves, but readers only wait for
+// a save while it publishes its chunk, never while it gets encoded and written.
+class HistoryStore {
+public:
+    static constexpr uint32_t chunk_magic  = 0x4348544E; // "NTHC"
+    static constexpr uint32_t index_magic  = 0x4948544E; // "NTHI"
+    static constexpr uint32_t file_version = 1;
+
+    // The directory gets created on the first save
+    explicit HistoryStore(std::filesystem::path directory);
+
+    HistoryStore(const HistoryStore&)            = delete;
+    HistoryStore& operator=(const HistoryStore&) = delete;
+
+    // First and last day with a saved meal
+    [[nodiscard]] std::optional<std::pair<std::chrono::sys_days, std::chrono::sys_days>> date_range() const;
+
+    // Fills `totals` with the meals eaten from `first` to `last`, both inclusive
+    void load_totals(std::chrono::sys_days first, std::chrono::sys_days last, std::span<const size_t> columns,
+        HistoryTotals& totals) const;
+
+    // Sums of the totals of every meal eaten from `first` to `last`, both inclusive, in O(log days)
+    [[nodiscard]] RangeTotals range_totals(std::chrono::sys_days first, std::chrono::sys_days last) const;
+
+    [[nodiscard]] std::optional<MealSnapshot> load_meal(const MealKey& key, const FoodCatalog& food_catalog) const;
+
+    // Changes every time a meal gets stored, so that views of the history know when to reload
+    [[nodiscard]] uint64_t revision() const noexcept {
+        return m_revision.load(std::memory_order_acquire);
+    }
+
+    // Adds the meal to the history, or replaces the one saved under the same key
+    bool store_meal(const MealKey& key, const MealSnapshot& meal, const FoodCatalog& food_catalog);
+
+private:
+    struct ChunkEntry {
+        int32_t month;
+        uint32_t meal_count;
+        int32_t first_day;
+        int32_t last_day;
+
+        bool operator==(const ChunkEntry&) const = default;
+    };
+
+    [[nodiscard]] std::filesystem::path chunk_path(int32_t month) const;
+    void read_index();
+    void recover_chunks();
+    [[nodiscard]] bool write_index(std::span<const ChunkEntry> chunks) const;
+    void build_rollup() const;
+
+private:
+    std::filesystem::path m_directory;
+
+    // Held by a save from reading the chunk it replaces until the index is written, so that the chunk files only
+    // change under it. `m_mutex` guards the state that readers see, which only changes while both are held.
+    mutable std::mutex m_write_mutex;
+    mutable std::mutex m_mutex;
+    std::vector<ChunkEntry> m_chunks; // Sorted by month
+
+    mutable DailyRollup m_rollup;
+    mutable bool m_has_rollup = false;
+
+    std::atomic<uint64_t> m_revision = 0;
+};
@@ -0,0 +1,69 @@
+#include "LodSeries.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+namespace {
+
+LodBucket merge(const LodBucket& left, const LodBucket& right) noexcept {
+    if (left.count == 0) {
+        return right;
+    }
+    if (right.count == 0) {
+        return left;
+    }
+
+    const auto count = left.count + right.count;
+    const auto mean  = (static_cast<double>(left.mean) * left.count + static_cast<double>(right.mean) * right.count) /
+        count;
+    return {
+        .min   = std::min(left.min, right.min),
+        .max   = std::max(left.max, right.max),
+        .mean  = static_cast<float>(mean),
+        .count = count,
+    };
+}
+
+} // namespace
+
+
+LodSeries::LodSeries(const std::span<const float> samples) {
+    if (samples.empty()) {
+        return;
+    }
+
+    auto& base = m_levels.emplace_back();
+    base.reserve(samples.size());
+    for (const auto sample : samples) {
+        if (std::isnan(sample)) {
+            base.push_back({});
+        } else {
+            base.push_back({ .min = sample, .max = sample, .mean = sample, .count = 1 });
+        }
+    }
+
+    // Every level halves the one below, an odd bucket out is carried up on its own
+    while (m_levels.back().size() > 1) {
+        const auto& below = m_levels.back();
+        auto level        = std::vector<LodBucket>{};
+        level.reserve((below.size() + 1) / 2);
+
+        for (size_t index = 0; index + 1 < below.size(); index += 2) {
+            level.push_back(merge(below[index], below[index + 1]));
+        }
+        if (below.size() % 2 != 0) {
+            level.push_back(below.back());
+        }
+        m_levels.push_back(std::move(level));
+    }
+}
+
+size_t LodSeries::pick_level(const size_t first, const size_t last, const size_t max_buckets) const noexcept {
+    const auto sample_count = last > first ? last - first : 0;
+    auto level              = size_t{ 0 };
+    while (level + 1 < m_levels.size() && sample_count > max_buckets * samples_per_bucket(level)) {
+        ++level;
+    }
+    return level;
+}
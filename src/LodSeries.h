@@ -0,0 +1,50 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <cstdint>
+
+
+// Summary of a run of consecutive samples of a series
+struct LodBucket {
+    float min      = 0.0f;
+    float max      = 0.0f;
+    float mean     = 0.0f;
+    uint32_t count = 0; // Samples that are present, a bucket without any is a gap in the series
+};
+
+
+// A series of samples along with a pyramid of min/max/mean decimations of it. Level 0 has one bucket per sample and
+// every level above merges pairs of buckets of the one below, so level `l` summarizes `2^l` samples per bucket.
+//
+// A graph draws the coarsest level that still has about one bucket per pixel of the visible range, so the vertices it
+// submits are bounded by its width in pixels rather than by the length of the series. Keeping the min and max of every
+// bucket, rather than only picking samples, keeps the spikes of the series visible at every zoom level.
+class LodSeries {
+public:
+    LodSeries() = default;
+
+    // NaN samples are missing ones
+    explicit LodSeries(std::span<const float> samples);
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_levels.empty() ? 0 : m_levels.front().size();
+    }
+
+    [[nodiscard]] size_t level_count() const noexcept {
+        return m_levels.size();
+    }
+
+    [[nodiscard]] std::span<const LodBucket> level(const size_t level) const noexcept {
+        return m_levels[level];
+    }
+
+    [[nodiscard]] static size_t samples_per_bucket(const size_t level) noexcept {
+        return size_t{ 1 } << level;
+    }
+
+    // Finest level that draws the samples `[first, last)` with at most `max_buckets` buckets
+    [[nodiscard]] size_t pick_level(size_t first, size_t last, size_t max_buckets) const noexcept;
+
+private:
+    std::vector<std::vector<LodBucket>> m_levels;
+};
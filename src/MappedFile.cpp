@@ -0,0 +1,94 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <unistd.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#endif
+
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+    const auto file =
+        CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    auto size = LARGE_INTEGER{};
+    if (GetFileSizeEx(file, &size) == 0 || size.QuadPart == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    // The view keeps the mapping alive, so both handles can be closed right away
+    const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return;
+    }
+
+    m_data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    m_size = (m_data != nullptr) ? static_cast<size_t>(size.QuadPart) : 0;
+    CloseHandle(mapping);
+#else
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) == -1 || info.st_size == 0) {
+        close(fd);
+        return;
+    }
+
+    // The mapping keeps the file alive, so the descriptor can be closed right away
+    auto* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return;
+    }
+
+    m_data = static_cast<const std::byte*>(data);
+    m_size = static_cast<size_t>(info.st_size);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+void MappedFile::unmap() noexcept {
+    if (m_data == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+#else
+    munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <span>
+#include <cstddef>
+#include <filesystem>
+
+
+// Read-only memory mapping of a whole file. The mapping stays valid, and at the same address, for as long as the object
+// (or the object it was moved into) lives.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept {
+        return m_data != nullptr;
+    }
+
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+        return { m_data, m_size };
+    }
+
+private:
+    void unmap() noexcept;
+
+private:
+    const std::byte* m_data = nullptr;
+    size_t m_size           = 0;
+};
@@ -0,0 +1,100 @@
+#include "Meal.h"
+
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include "MemoryStats.h"
+
+
+bool MealSnapshot::apply(const MealEdit& edit) {
+    switch (edit.kind) {
+    case MealEdit::Kind::AddRow:
+        rows.push_back(edit.food);
+        return true;
+
+    case MealEdit::Kind::RemoveRow:
+        if (edit.row >= rows.size()) {
+            return false;
+        }
+        rows.erase(rows.begin() + static_cast<std::ptrdiff_t>(edit.row));
+        return true;
+
+    case MealEdit::Kind::SetRow:
+        if (edit.row >= rows.size()) {
+            return false;
+        }
+        rows[edit.row] = edit.food;
+        return true;
+
+    case MealEdit::Kind::ScaleRows:
+        for (auto& row : rows) {
+            for (auto& value : row.values) {
+                value *= edit.factor;
+            }
+        }
+        return true;
+
+    case MealEdit::Kind::SetTitle:
+        title = edit.text;
+        return true;
+
+    case MealEdit::Kind::SetNotes:
+        notes = edit.text;
+        return true;
+    }
+    return false;
+}
+
+MealSnapshot MealSnapshot::from_json(const nlohmann::json& json_serial, const FoodCatalog& food_catalog) {
+    MEMORY_TAG(MealModel);
+
+    auto result = MealSnapshot{};
+
+    if (json_serial.contains("rows")) {
+        result.rows.reserve(json_serial.at("rows").size());
+
+        for (const auto& row : json_serial["rows"]) {
+            const auto name = row.at("name").get<std::string>();
+            const auto id   = food_catalog.find_id(name);
+
+            if (!id.has_value()) {
+                fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: The food '{}' is not in the catalog, skipping it\n",
+                    name);
+                continue;
+            }
+            result.rows.push_back({ .id = *id, .values = row.at("values").get<std::array<float, 5>>() });
+        }
+    }
+
+    if (json_serial.contains("title")) {
+        json_serial["title"].get_to(result.title);
+    }
+
+    if (json_serial.contains("notes")) {
+        json_serial["notes"].get_to(result.notes);
+    }
+
+    return result;
+}
+
+nlohmann::json MealSnapshot::to_json(const FoodCatalog& food_catalog) const {
+    MEMORY_TAG(MealModel);
+
+    auto result = nlohmann::json{};
+    for (const auto& row : rows) {
+        result["rows"].push_back({ { "name", food_catalog.name(row.id) }, { "values", row.values } });
+    }
+
+    result["title"] = title;
+    result["notes"] = notes;
+    return result;
+}
+
+void write_food(std::string& out, const Food& food, const FoodCatalog& food_catalog) {
+    binary::put_string(out, food_catalog.contains(food.id) ? food_catalog.name(food.id) : std::string_view{});
+    binary::put(out, food.values);
+}
+
+Food read_food(binary::Reader& reader, const FoodCatalog& food_catalog) {
+    const auto id = food_catalog.find_id(reader.get_string());
+    return { .id = id.value_or(FoodId::Invalid), .values = reader.get<std::array<float, 5>>() };
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "Food.h"
+#include "BinaryIO.h"
+#include "FoodCatalog.h"
+
+
+// A single edit of a meal. Edits are what the meal journal records, so that saving an edit costs as much as the edit
+// rather than as much as the whole meal.
+struct MealEdit {
+    enum class Kind : uint8_t {
+        AddRow = 0,
+        RemoveRow,
+        SetRow,
+        ScaleRows,
+        SetTitle,
+        SetNotes,
+    };
+
+    Kind kind        = Kind::AddRow;
+    uint32_t row     = 0;    // `RemoveRow` and `SetRow`
+    Food food        = {};   // `AddRow` and `SetRow`
+    float factor     = 1.0f; // `ScaleRows`
+    std::string text = {};   // `SetTitle` and `SetNotes`
+
+    [[nodiscard]] static MealEdit add_row(const Food& food) {
+        return { .kind = Kind::AddRow, .food = food };
+    }
+
+    [[nodiscard]] static MealEdit remove_row(const size_t row) {
+        return { .kind = Kind::RemoveRow, .row = static_cast<uint32_t>(row) };
+    }
+
+    [[nodiscard]] static MealEdit set_row(const size_t row, const Food& food) {
+        return { .kind = Kind::SetRow, .row = static_cast<uint32_t>(row), .food = food };
+    }
+
+    // Multiplies every value of every row by `factor`
+    [[nodiscard]] static MealEdit scale_rows(const float factor) {
+        return { .kind = Kind::ScaleRows, .factor = factor };
+    }
+
+    [[nodiscard]] static MealEdit set_title(std::string title) {
+        return { .kind = Kind::SetTitle, .text = std::move(title) };
+    }
+
+    [[nodiscard]] static MealEdit set_notes(std::string notes) {
+        return { .kind = Kind::SetNotes, .text = std::move(notes) };
+    }
+};
+
+
+// Plain copy of everything that gets saved about a meal, cheap enough to hand over to another thread
+struct MealSnapshot {
+    std::string title      = {};
+    std::string notes      = {};
+    std::vector<Food> rows = {};
+
+    bool operator==(const MealSnapshot&) const = default;
+
+    // Returns false, leaving the meal untouched, when the edit refers to a row that doesn't exist
+    bool apply(const MealEdit& edit);
+
+    // Foods that aren't in the catalog are skipped
+    [[nodiscard]] static MealSnapshot from_json(const nlohmann::json& json_serial, const FoodCatalog& food_catalog);
+    [[nodiscard]] nlohmann::json to_json(const FoodCatalog& food_catalog) const;
+};
+
+
+// Foods are saved by name rather than by id, so that saved meals stay valid when the food database changes. Foods that
+// aren't in the catalog (anymore) are read back as `FoodId::Invalid`.
+void write_food(std::string& out, const Food& food, const FoodCatalog& food_catalog);
+[[nodiscard]] Food read_food(binary::Reader& reader, const FoodCatalog& food_catalog);
@@ -0,0 +1,300 @@
+#include "MealDocument.h"
+
+#include <limits>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <unordered_map>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include "BinaryIO.h"
+#include "AtomicFile.h"
+#include "HistoryStore.h"
+#include "MemoryStats.h"
+#include "Profiler.h"
+
+
+namespace {
+
+constexpr size_t value_count = std::tuple_size_v<decltype(Food::values)>;
+
+// Day of the meals that don't have one
+constexpr auto no_day = std::numeric_limits<int32_t>::min();
+
+// The header is followed by `food_count` names, then by `meal_count` meals, then by the columns
+// `uint32_t food_refs[row_count]` and one `float values[row_count]` per value, with the rows of every meal in order
+struct DocumentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t journal_sequence;
+    uint32_t meal_count;
+    uint32_t food_count;
+    uint32_t row_count;
+    uint32_t reserved;
+};
+
+// Followed by the title and the notes of the meal
+struct MealHeader {
+    int32_t day;
+    uint32_t index;
+    uint32_t row_count;
+};
+
+// The least bytes that a name, a meal and a row take, which bounds the counts that a document of a size can hold
+constexpr size_t min_name_size = sizeof(uint32_t);
+constexpr size_t min_meal_size = sizeof(MealHeader) + 2 * sizeof(uint32_t);
+constexpr size_t row_size      = sizeof(uint32_t) + value_count * sizeof(float);
+
+int32_t day_number(const std::optional<std::chrono::sys_days> day) noexcept {
+    return day.has_value() ? static_cast<int32_t>(day->time_since_epoch().count()) : no_day;
+}
+
+std::optional<std::chrono::sys_days> day_from_number(const int32_t number) noexcept {
+    if (number == no_day) {
+        return std::nullopt;
+    }
+    return std::chrono::sys_days{ std::chrono::days{ number } };
+}
+
+} // namespace
+
+
+std::string MealDocument::encode(const FoodCatalog& food_catalog) const {
+    PROFILE_FUNCTION();
+    MEMORY_TAG(MealModel);
+
+    // Foods get numbered in the order that the rows first use them
+    auto food_refs  = std::unordered_map<FoodId, uint32_t>{};
+    auto names      = std::vector<std::string_view>{};
+    auto row_refs   = std::vector<uint32_t>{};
+    auto names_size = size_t{ 0 };
+    for (const auto& document_meal : meals) {
+        for (const auto& row : document_meal.meal.rows) {
+            const auto [food_ref, is_new] = food_refs.try_emplace(row.id, static_cast<uint32_t>(names.size()));
+            if (is_new) {
+                names.push_back(food_catalog.contains(row.id) ? food_catalog.name(row.id) : std::string_view{});
+                names_size += names.back().size();
+            }
+            row_refs.push_back(food_ref->second);
+        }
+    }
+
+    auto meals_size = size_t{ 0 };
+    for (const auto& document_meal : meals) {
+        meals_size += min_meal_size + document_meal.meal.title.size() + document_meal.meal.notes.size();
+    }
+
+    const auto size = sizeof(DocumentHeader) + names.size() * min_name_size + names_size + meals_size +
+        row_refs.size() * row_size;
+    auto out = std::string{};
+    out.reserve(size);
+
+    binary::put(out, DocumentHeader{
+        .magic            = magic,
+        .version          = schema_version,
+        .journal_sequence = journal_sequence,
+        .meal_count       = static_cast<uint32_t>(meals.size()),
+        .food_count       = static_cast<uint32_t>(names.size()),
+        .row_count        = static_cast<uint32_t>(row_refs.size()),
+        .reserved         = 0,
+    });
+
+    for (const auto name : names) {
+        binary::put_string(out, name);
+    }
+
+    for (const auto& document_meal : meals) {
+        binary::put(out, MealHeader{
+            .day       = day_number(document_meal.day),
+            .index     = document_meal.index,
+            .row_count = static_cast<uint32_t>(document_meal.meal.rows.size()),
+        });
+        binary::put_string(out, document_meal.meal.title);
+        binary::put_string(out, document_meal.meal.notes);
+    }
+
+    // The columns are copied into place rather than appended value by value
+    const auto columns_offset = out.size();
+    out.resize(columns_offset + row_refs.size() * row_size);
+    std::memcpy(out.data() + columns_offset, row_refs.data(), row_refs.size() * sizeof(uint32_t));
+
+    auto* column = out.data() + columns_offset + row_refs.size() * sizeof(uint32_t);
+    for (size_t value = 0; value < value_count; ++value) {
+        for (const auto& document_meal : meals) {
+            for (const auto& row : document_meal.meal.rows) {
+                std::memcpy(column, &row.values[value], sizeof(float));
+                column += sizeof(float);
+            }
+        }
+    }
+    return out;
+}
+
+std::optional<MealDocument> MealDocument::decode(const std::string_view bytes, const FoodCatalog& food_catalog) {
+    PROFILE_FUNCTION();
+    MEMORY_TAG(MealModel);
+
+    auto reader       = binary::Reader{ bytes };
+    const auto header = reader.get<DocumentHeader>();
+
+    // The counts are checked against the size first, so that a corrupted document can't make it allocate much
+    const auto remaining = reader.remaining();
+    if (reader.failed() || header.magic != magic || header.version == 0 || header.version > schema_version ||
+        header.food_count > remaining / min_name_size || header.meal_count > remaining / min_meal_size ||
+        header.row_count > remaining / row_size) {
+        return std::nullopt;
+    }
+
+    // Every name gets looked up once, however many rows use it
+    auto food_ids      = std::vector<FoodId>{};
+    auto unknown_foods = size_t{ 0 };
+    food_ids.reserve(header.food_count);
+    for (uint32_t food = 0; food < header.food_count; ++food) {
+        const auto name = reader.get_string();
+        const auto id   = food_catalog.find_id(name);
+        if (!reader.failed() && !id.has_value()) {
+            fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: The food '{}' is not in the catalog, skipping it\n",
+                name);
+            unknown_foods += 1;
+        }
+        food_ids.push_back(id.value_or(FoodId::Invalid));
+    }
+
+    auto document  = MealDocument{ .journal_sequence = header.journal_sequence };
+    auto rows_left = size_t{ header.row_count };
+    document.meals.resize(header.meal_count);
+    for (auto& document_meal : document.meals) {
+        const auto meal_header   = reader.get<MealHeader>();
+        document_meal.day        = day_from_number(meal_header.day);
+        document_meal.index      = meal_header.index;
+        document_meal.meal.title = reader.get_string();
+        document_meal.meal.notes = reader.get_string();
+
+        if (meal_header.row_count > rows_left) {
+            return std::nullopt;
+        }
+        rows_left -= meal_header.row_count;
+        document_meal.meal.rows.resize(meal_header.row_count);
+    }
+
+    const auto row_refs = reader.get_bytes(header.row_count * sizeof(uint32_t));
+    auto columns        = std::array<std::string_view, value_count>{};
+    for (auto& column : columns) {
+        column = reader.get_bytes(header.row_count * sizeof(float));
+    }
+
+    if (reader.failed() || reader.remaining() != 0 || rows_left != 0) {
+        return std::nullopt;
+    }
+
+    auto row_index = size_t{ 0 };
+    for (auto& document_meal : document.meals) {
+        for (auto& row : document_meal.meal.rows) {
+            auto food_ref = uint32_t{ 0 };
+            std::memcpy(&food_ref, row_refs.data() + row_index * sizeof(uint32_t), sizeof(uint32_t));
+            if (food_ref >= food_ids.size()) {
+                return std::nullopt;
+            }
+
+            row.id = food_ids[food_ref];
+            for (size_t value = 0; value < value_count; ++value) {
+                std::memcpy(&row.values[value], columns[value].data() + row_index * sizeof(float), sizeof(float));
+            }
+            row_index += 1;
+        }
+
+        if (unknown_foods != 0) {
+            std::erase_if(document_meal.meal.rows, [](const Food& row) { return row.id == FoodId::Invalid; });
+        }
+    }
+    return document;
+}
+
+nlohmann::json MealDocument::to_json(const FoodCatalog& food_catalog) const {
+    PROFILE_FUNCTION();
+    MEMORY_TAG(MealModel);
+
+    auto json_meals = nlohmann::json::array();
+    for (const auto& document_meal : meals) {
+        auto json_meal = document_meal.meal.to_json(food_catalog);
+        if (document_meal.day.has_value()) {
+            json_meal["day"] = format_day(*document_meal.day);
+        }
+        json_meal["meal"] = document_meal.index;
+        json_meals.push_back(std::move(json_meal));
+    }
+
+    auto result     = nlohmann::json{};
+    result["meals"] = std::move(json_meals);
+    if (journal_sequence != 0) {
+        result["journal_sequence"] = journal_sequence;
+    }
+    return result;
+}
+
+MealDocument MealDocument::from_json(const nlohmann::json& json_serial, const FoodCatalog& food_catalog) {
+    PROFILE_FUNCTION();
+    MEMORY_TAG(MealModel);
+
+    const auto read_meal = [&](const nlohmann::json& json_meal) {
+        return DocumentMeal{
+            .day   = parse_day(json_meal.value("day", ""s)),
+            .index = json_meal.value("meal", 0u),
+            .meal  = MealSnapshot::from_json(json_meal, food_catalog),
+        };
+    };
+
+    auto document = MealDocument{ .journal_sequence = json_serial.value("journal_sequence", uint64_t{ 0 }) };
+    if (const auto json_meals = json_serial.find("meals"); json_meals != json_serial.end()) {
+        document.meals.reserve(json_meals->size());
+        for (const auto& json_meal : *json_meals) {
+            document.meals.push_back(read_meal(json_meal));
+        }
+    } else {
+        document.meals.push_back(read_meal(json_serial));
+    }
+    return document;
+}
+
+std::optional<MealDocument> MealDocument::load(const std::filesystem::path& path, const FoodCatalog& food_catalog) {
+    PROFILE_FUNCTION();
+
+    auto file = std::ifstream{ path, std::ios::binary };
+    if (!file) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Could not open {}\n", path);
+        return std::nullopt;
+    }
+    const auto bytes = std::string{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+    if (auto file_magic = uint32_t{ 0 }; bytes.size() >= sizeof(file_magic)) {
+        std::memcpy(&file_magic, bytes.data(), sizeof(file_magic));
+        if (file_magic == magic) {
+            auto document = decode(bytes, food_catalog);
+            if (!document.has_value()) {
+                fmt::print(stderr, fmt::fg(fmt::color::red),
+                    "[ERROR]: The meal {} is corrupted or was saved by a newer version, ignoring it\n", path);
+            }
+            return document;
+        }
+    }
+
+    const auto json_serial = nlohmann::json::parse(bytes, nullptr, false);
+    if (json_serial.is_discarded() || !json_serial.is_object()) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: The meal {} is not valid json, ignoring it\n", path);
+        return std::nullopt;
+    }
+
+    try {
+        return from_json(json_serial, food_catalog);
+    } catch (const nlohmann::json::exception& exception) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: The meal {} is malformed, ignoring it: {}\n", path,
+            exception.what());
+        return std::nullopt;
+    }
+}
+
+bool MealDocument::save(const std::filesystem::path& path, const FoodCatalog& food_catalog) const {
+    return atomic_write_file(path, encode(food_catalog));
+}
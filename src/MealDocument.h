@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <filesystem>
+#include <string_view>
+#include <nlohmann/json.hpp>
+#include "Meal.h"
+#include "FoodCatalog.h"
+
+
+// A meal of a document, with the day it was eaten on
+struct DocumentMeal {
+    std::optional<std::chrono::sys_days> day = {}; // Meals exported on their own don't have one
+    uint32_t index                           = 0;  // Among the meals of its day
+    MealSnapshot meal                        = {};
+
+    bool operator==(const DocumentMeal&) const = default;
+};
+
+
+// Any number of meals saved in one file: the snapshot of today's meal, a day, or a whole exported history.
+//
+// Documents are saved in a compact binary format. A header with the format's schema version and the counts is followed
+// by a table of the names of the foods that the document uses, each one only once, then by the title, notes and row
+// count of every meal, and then by the rows of every meal as columns: an index into the name table per row, then one
+// packed `float` array per value. Nothing of the format depends on the catalog, so documents stay valid when the food
+// database changes.
+//
+// JSON stays available for importing and exporting documents, and for reading the meals and snapshots saved before
+// the binary format existed.
+struct MealDocument {
+    static constexpr uint32_t magic          = 0x444D544E; // "NTMD"
+    static constexpr uint32_t schema_version = 1;
+    static constexpr auto extension          = ".meal"sv;
+
+    std::vector<DocumentMeal> meals = {};
+    uint64_t journal_sequence       = 0; // Snapshots: the last record of the meal journal that they include
+
+    bool operator==(const MealDocument&) const = default;
+
+    [[nodiscard]] std::string encode(const FoodCatalog& food_catalog) const;
+
+    // Fails on anything that isn't a whole document of a schema version up to the current one. The rows of foods that
+    // aren't in the catalog are skipped, like `MealSnapshot::from_json` does.
+    [[nodiscard]] static std::optional<MealDocument> decode(std::string_view bytes, const FoodCatalog& food_catalog);
+
+    [[nodiscard]] nlohmann::json to_json(const FoodCatalog& food_catalog) const;
+
+    // Takes both `to_json`'s output and a single meal, with or without the "day", "meal" and "journal_sequence" of a
+    // snapshot. Throws `nlohmann::json::exception` when the json is malformed.
+    [[nodiscard]] static MealDocument from_json(const nlohmann::json& json_serial, const FoodCatalog& food_catalog);
+
+    // Reads a document in either format, telling them apart by the magic
+    [[nodiscard]] static std::optional<MealDocument> load(const std::filesystem::path& path,
+        const FoodCatalog& food_catalog);
+
+    // In the binary format, replacing the file atomically
+    bool save(const std::filesystem::path& path, const FoodCatalog& food_catalog) const;
+};
@@ -0,0 +1,228 @@
+#include "MealJournal.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include "BinaryIO.h"
+#include "AtomicFile.h"
+#include "Profiler.h"
+
+#ifdef _WIN32
+#    include <io.h>
+#else
+#    include <unistd.h>
+#endif
+
+
+namespace {
+
+using binary::put;
+using binary::put_string;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+};
+
+struct RecordHeader {
+    uint32_t payload_size;
+    uint32_t checksum;
+};
+
+// Anything bigger can only be a corrupt size
+constexpr uint32_t max_payload_size = 1 << 24;
+
+// CRC-32 (IEEE 802.3), the one used by zlib and png
+constexpr auto crc32_table = [] {
+    auto table = std::array<uint32_t, 256>{};
+    for (uint32_t index = 0; index < table.size(); ++index) {
+        auto crc = index;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+        table[index] = crc;
+    }
+    return table;
+}();
+
+uint32_t crc32(const std::string_view bytes) noexcept {
+    auto crc = ~uint32_t{ 0 };
+    for (const auto byte : bytes) {
+        crc = crc32_table[(crc ^ static_cast<uint8_t>(byte)) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+std::optional<MealJournal::Record> decode(const std::string_view payload, const FoodCatalog& food_catalog) {
+    using Kind = MealEdit::Kind;
+
+    auto reader = binary::Reader{ payload };
+    auto record = MealJournal::Record{ .sequence = reader.get<uint64_t>() };
+    auto& edit  = record.edit;
+    edit.kind   = static_cast<Kind>(reader.get<uint8_t>());
+
+    switch (edit.kind) {
+    case Kind::AddRow:
+        edit.food = read_food(reader, food_catalog);
+        break;
+    case Kind::RemoveRow:
+        edit.row = reader.get<uint32_t>();
+        break;
+    case Kind::SetRow:
+        edit.row  = reader.get<uint32_t>();
+        edit.food = read_food(reader, food_catalog);
+        break;
+    case Kind::ScaleRows:
+        edit.factor = reader.get<float>();
+        break;
+    case Kind::SetTitle:
+    case Kind::SetNotes:
+        edit.text = reader.get_string();
+        break;
+    default:
+        return std::nullopt;
+    }
+
+    return reader.failed() ? std::nullopt : std::optional{ std::move(record) };
+}
+
+bool sync(std::FILE* file) {
+#ifdef _WIN32
+    return std::fflush(file) == 0 && _commit(_fileno(file)) == 0;
+#else
+    return std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+#endif
+}
+
+} // namespace
+
+
+std::optional<MealJournal::Contents> MealJournal::read(
+    const std::filesystem::path& path, const FoodCatalog& food_catalog) {
+    PROFILE_FUNCTION();
+
+    auto file = std::ifstream{ path, std::ios::binary };
+    if (!file) {
+        return std::nullopt;
+    }
+
+    const auto bytes = std::string{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    auto data        = std::string_view{ bytes };
+
+    auto header = FileHeader{};
+    if (data.size() < sizeof(header)) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    data.remove_prefix(sizeof(header));
+
+    if (header.magic != file_magic || header.version != file_version) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: {} is not a meal journal this version can read\n", path);
+        return std::nullopt;
+    }
+
+    auto contents = Contents{};
+    while (!data.empty()) {
+        auto record_header = RecordHeader{};
+        if (data.size() < sizeof(record_header)) {
+            contents.is_torn = true;
+            break;
+        }
+        std::memcpy(&record_header, data.data(), sizeof(record_header));
+        data.remove_prefix(sizeof(record_header));
+
+        if (record_header.payload_size > max_payload_size || data.size() < record_header.payload_size) {
+            contents.is_torn = true;
+            break;
+        }
+
+        const auto payload = data.substr(0, record_header.payload_size);
+        data.remove_prefix(record_header.payload_size);
+
+        auto record = (crc32(payload) == record_header.checksum) ? decode(payload, food_catalog) : std::nullopt;
+        if (!record.has_value()) {
+            contents.is_torn = true;
+            break;
+        }
+        contents.records.push_back(std::move(*record));
+    }
+
+    return contents;
+}
+
+std::optional<MealJournal> MealJournal::create(const std::filesystem::path& path) {
+    auto header = std::string{};
+    put(header, FileHeader{ .magic = file_magic, .version = file_version });
+
+    if (!atomic_write_file(path, header)) {
+        return std::nullopt;
+    }
+    return open(path);
+}
+
+std::optional<MealJournal> MealJournal::open(const std::filesystem::path& path) {
+#ifdef _WIN32
+    auto* file = _wfopen(path.c_str(), L"ab");
+#else
+    auto* file = std::fopen(path.c_str(), "ab");
+#endif
+    if (file == nullptr) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Failed to open the meal journal {}\n", path);
+        return std::nullopt;
+    }
+
+    auto journal = MealJournal{};
+    journal.m_file.reset(file);
+    return journal;
+}
+
+void MealJournal::encode(const Record& record, const FoodCatalog& food_catalog, std::string& out) {
+    using Kind = MealEdit::Kind;
+
+    // The header gets filled in once the size of the payload is known
+    const auto header_offset = out.size();
+    put(out, RecordHeader{});
+
+    const auto payload_offset = out.size();
+    const auto& edit          = record.edit;
+    put(out, record.sequence);
+    put(out, static_cast<uint8_t>(edit.kind));
+
+    switch (edit.kind) {
+    case Kind::AddRow:
+        write_food(out, edit.food, food_catalog);
+        break;
+    case Kind::RemoveRow:
+        put(out, edit.row);
+        break;
+    case Kind::SetRow:
+        put(out, edit.row);
+        write_food(out, edit.food, food_catalog);
+        break;
+    case Kind::ScaleRows:
+        put(out, edit.factor);
+        break;
+    case Kind::SetTitle:
+    case Kind::SetNotes:
+        put_string(out, edit.text);
+        break;
+    }
+
+    const auto payload = std::string_view{ out }.substr(payload_offset);
+    const auto header  = RecordHeader{ .payload_size = static_cast<uint32_t>(payload.size()), .checksum = crc32(payload) };
+    std::memcpy(out.data() + header_offset, &header, sizeof(header));
+}
+
+bool MealJournal::append(const std::string_view records) {
+    PROFILE_FUNCTION();
+
+    if (std::fwrite(records.data(), 1, records.size(), m_file.get()) != records.size() || !sync(m_file.get())) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Failed to append to the meal journal\n");
+        return false;
+    }
+    return true;
+}
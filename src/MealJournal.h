@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <filesystem>
+#include <string_view>
+#include "Meal.h"
+#include "FoodCatalog.h"
+
+
+// Append-only log of the edits made to a meal since its last snapshot. Replaying the journal on top of the snapshot
+// restores the meal, and since records are only ever appended, a crash can at most tear the record being written.
+//
+// The file is a header (magic and version) followed by records: the size of the payload, its CRC-32 and the payload
+// itself, which is the record's sequence number, the kind of the edit and its fields. Foods are recorded by name, so
+// that a journal stays valid when the food database changes.
+class MealJournal {
+public:
+    static constexpr uint32_t file_magic   = 0x4A4D544E; // "NTMJ"
+    static constexpr uint32_t file_version = 1;
+
+    struct Record {
+        uint64_t sequence = 0;
+        MealEdit edit     = {};
+    };
+
+    struct Contents {
+        std::vector<Record> records = {};
+
+        // Set when the journal ends in a partially written or corrupt record, which is ignored along with anything
+        // after it
+        bool is_torn = false;
+    };
+
+    // Returns `std::nullopt` when there is no journal at `path`, or it isn't one. Foods that aren't in the catalog are
+    // read as `FoodId::Invalid`.
+    [[nodiscard]] static std::optional<Contents> read(const std::filesystem::path& path, const FoodCatalog& food_catalog);
+
+    // Atomically replaces the journal at `path` with an empty one and opens it
+    [[nodiscard]] static std::optional<MealJournal> create(const std::filesystem::path& path);
+
+    // Opens the existing journal at `path` to append to it
+    [[nodiscard]] static std::optional<MealJournal> open(const std::filesystem::path& path);
+
+    static void encode(const Record& record, const FoodCatalog& food_catalog, std::string& out);
+
+    // Appends records made by `encode` and flushes them to disk
+    bool append(std::string_view records);
+
+private:
+    struct FileCloser {
+        void operator()(std::FILE* file) const noexcept {
+            std::fclose(file);
+        }
+    };
+
+    std::unique_ptr<std::FILE, FileCloser> m_file;
+};
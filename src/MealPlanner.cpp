@@ -0,0 +1,204 @@
+#include "MealPlanner.h"
+
+#include <cmath>
+#include <algorithm>
+#include "Profiler.h"
+
+
+namespace {
+
+constexpr auto target_count = MealPlanner::target_count;
+
+template <typename Vector>
+double dot(const Vector& lhs, const Vector& rhs) noexcept {
+    auto result = 0.0;
+    for (size_t index = 0; index < target_count; ++index) {
+        result += lhs[index] * rhs[index];
+    }
+    return result;
+}
+
+// Solves `matrix * x = rhs` in place of `rhs` by a Cholesky decomposition, `matrix` has to be positive definite
+template <typename Matrix, typename Vector>
+void cholesky_solve(Matrix matrix, Vector& rhs) noexcept {
+    for (size_t column = 0; column < target_count; ++column) {
+        auto diagonal = matrix[column][column];
+        for (size_t index = 0; index < column; ++index) {
+            diagonal -= matrix[column][index] * matrix[column][index];
+        }
+        matrix[column][column] = std::sqrt(diagonal);
+
+        for (size_t row = column + 1; row < target_count; ++row) {
+            auto value = matrix[row][column];
+            for (size_t index = 0; index < column; ++index) {
+                value -= matrix[row][index] * matrix[column][index];
+            }
+            matrix[row][column] = value / matrix[column][column];
+        }
+    }
+
+    for (size_t row = 0; row < target_count; ++row) {
+        for (size_t index = 0; index < row; ++index) {
+            rhs[row] -= matrix[row][index] * rhs[index];
+        }
+        rhs[row] /= matrix[row][row];
+    }
+    for (size_t row = target_count; row-- > 0;) {
+        for (size_t index = row + 1; index < target_count; ++index) {
+            rhs[row] -= matrix[index][row] * rhs[index];
+        }
+        rhs[row] /= matrix[row][row];
+    }
+}
+
+} // namespace
+
+
+MealPlanner::MealPlanner(const std::span<const Candidate> candidates) {
+    set_candidates(candidates);
+}
+
+void MealPlanner::set_candidates(const std::span<const Candidate> candidates) {
+    m_nutrients_per_gram.clear();
+    m_min_weights.clear();
+    m_max_weights.clear();
+    m_anchor_weights.clear();
+
+    for (const auto& candidate : candidates) {
+        // A food without a weight can't contribute anything, it just stays where it is
+        auto& per_gram       = m_nutrients_per_gram.emplace_back();
+        const auto reference = static_cast<double>(candidate.props.props[Food::Weight]);
+        for (size_t index = 0; index < target_count; ++index) {
+            per_gram[index] = reference > 0.0 ? static_cast<double>(candidate.props.props[index]) / reference : 0.0;
+        }
+
+        const auto min_weight = std::max(static_cast<double>(candidate.min_weight), 0.0);
+        const auto max_weight = std::max(static_cast<double>(candidate.max_weight), min_weight);
+        m_min_weights.push_back(min_weight);
+        m_max_weights.push_back(max_weight);
+        m_anchor_weights.push_back(std::clamp(static_cast<double>(candidate.weight), min_weight, max_weight));
+    }
+
+    m_weights = m_anchor_weights;
+    m_dual    = {};
+}
+
+// With the weights' errors `r = A w - t` (every row divided by its target) and the penalty `λ/2 |w - w0|²`, the dual
+// of the problem is `g(y) = min over the bounds of (λ/2 |w - w0|² + y·(A w - t)) - |y|²/2`. The minimum splits into one
+// per weight, `w = clamp(w0 - Aᵀy / λ)`, and `g` is concave with the gradient `A w - t - y`, which is zero exactly when
+// `y` equals the errors of the weights that solve the problem.
+MealPlanner::Evaluation MealPlanner::evaluate(const Targets& dual, const Targets& scaled_targets,
+    const Targets& inverse_scales, const double regularization) {
+    auto evaluation = Evaluation{};
+    auto totals     = Targets{};
+    for (size_t index = 0; index < target_count; ++index) {
+        evaluation.hessian[index][index] = 1.0;
+    }
+
+    for (size_t food = 0; food < m_weights.size(); ++food) {
+        auto column = Targets{};
+        for (size_t index = 0; index < target_count; ++index) {
+            column[index] = m_nutrients_per_gram[food][index] * inverse_scales[index];
+        }
+
+        const auto anchor   = m_anchor_weights[food];
+        const auto optimum  = anchor - dot(column, dual) / regularization;
+        const auto weight   = std::clamp(optimum, m_min_weights[food], m_max_weights[food]);
+        const auto movement = weight - anchor;
+        m_weights[food]     = weight;
+
+        evaluation.value += 0.5 * regularization * movement * movement;
+        for (size_t index = 0; index < target_count; ++index) {
+            totals[index] += column[index] * weight;
+        }
+
+        // Clamped weights don't move with the dual, so they don't bend `g`
+        if (optimum > m_min_weights[food] && optimum < m_max_weights[food]) {
+            for (size_t row = 0; row < target_count; ++row) {
+                for (size_t index = 0; index <= row; ++index) {
+                    evaluation.hessian[row][index] += column[row] * column[index] / regularization;
+                }
+            }
+        }
+    }
+
+    for (size_t row = 0; row < target_count; ++row) {
+        for (size_t index = 0; index < row; ++index) {
+            evaluation.hessian[index][row] = evaluation.hessian[row][index];
+        }
+    }
+
+    for (size_t index = 0; index < target_count; ++index) {
+        const auto error           = totals[index] - scaled_targets[index];
+        evaluation.gradient[index] = error - dual[index];
+        evaluation.value += dual[index] * error - 0.5 * dual[index] * dual[index];
+    }
+    return evaluation;
+}
+
+MealPlanner::Result MealPlanner::solve(const Targets& targets, const Options& options) {
+    PROFILE_FUNCTION();
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // Every error is relative to its target, so that the grams of fat weigh as much as the calories. Targets below one
+    // are compared in absolute terms instead, which keeps a target of zero from dividing by zero.
+    auto scaled_targets = Targets{};
+    auto inverse_scales = Targets{};
+    for (size_t index = 0; index < target_count; ++index) {
+        if (!std::isnan(targets[index])) {
+            inverse_scales[index] = 1.0 / std::max(std::abs(targets[index]), 1.0);
+            scaled_targets[index] = targets[index] * inverse_scales[index];
+        }
+    }
+
+    const auto regularization = std::max(options.regularization, 1e-12);
+    const auto converged      = [&](const Evaluation& evaluation) {
+        return std::ranges::all_of(evaluation.gradient, [&](const double error) {
+            return std::abs(error) <= options.tolerance;
+        });
+    };
+
+    auto result     = Result{};
+    auto evaluation = evaluate(m_dual, scaled_targets, inverse_scales, regularization);
+    while (!(result.converged = converged(evaluation)) && result.iterations < options.max_iterations &&
+           std::chrono::steady_clock::now() - start_time < options.time_budget) {
+        result.iterations += 1;
+
+        // `g` is piecewise quadratic, so the Newton step is exact unless a weight hits or leaves one of its bounds on
+        // the way. Halving it until `g` grows enough makes sure that it always gets closer.
+        auto step = evaluation.gradient;
+        cholesky_solve(evaluation.hessian, step);
+        const auto slope = dot(step, evaluation.gradient);
+
+        auto accepted = false;
+        for (auto length = 1.0; length > 1e-10 && !accepted; length *= 0.5) {
+            auto dual = m_dual;
+            for (size_t index = 0; index < target_count; ++index) {
+                dual[index] += length * step[index];
+            }
+
+            auto candidate = evaluate(dual, scaled_targets, inverse_scales, regularization);
+            if (candidate.value >= evaluation.value + 1e-4 * length * slope) {
+                m_dual     = dual;
+                evaluation = candidate;
+                accepted   = true;
+            }
+        }
+
+        // Only the rounding errors are left to improve on
+        if (!accepted) {
+            evaluation = evaluate(m_dual, scaled_targets, inverse_scales, regularization);
+            break;
+        }
+    }
+
+    for (size_t food = 0; food < m_weights.size(); ++food) {
+        for (size_t index = 0; index < target_count; ++index) {
+            result.totals[index] += m_nutrients_per_gram[food][index] * m_weights[food];
+        }
+    }
+
+    m_anchor_weights = m_weights;
+    return result;
+}
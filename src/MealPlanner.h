@@ -0,0 +1,91 @@
+#pragma once
+#include <span>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include "Food.h"
+
+
+// Solves for the weights of a meal's foods whose nutrients come the closest to a set of targets. It's a bounded least
+// squares problem: the squared errors of protein, carbo, fat and calories, each relative to its target, plus a slight
+// penalty on moving the weights away from where they were, with every weight kept within its food's bounds.
+//
+// The penalty makes the solution unique and keeps it from jumping around between equally good meals while the targets
+// are dragged. With it, the dual of the problem has only one variable per target and every weight is a clamped linear
+// function of them, so each Newton step costs a pass over the foods and a 4x4 solve, however many foods there are.
+//
+// Every solve warm starts from the last one: the weights it found become the weights to stay close to, and its dual
+// the starting point of the next. Targets that move a little between frames then take an iteration or two.
+class MealPlanner {
+public:
+    static constexpr auto target_count = size_t{ Food::Weight };
+
+    // Indexed by `Food::ValueIndex`. A NaN target leaves its nutrient free.
+    using Targets = std::array<double, target_count>;
+
+    struct Candidate {
+        FoodProps props  = {};
+        float weight     = 0.0f; // Where the solver starts from
+        float min_weight = 0.0f;
+        float max_weight = std::numeric_limits<float>::infinity();
+    };
+
+    struct Options {
+        // Cost of moving a weight by a gram, next to the squared relative error of a nutrient
+        double regularization = 1e-8;
+        // Largest error of a nutrient relative to its target, at which the solution is considered found
+        double tolerance                      = 1e-6;
+        size_t max_iterations                 = 50;
+        std::chrono::microseconds time_budget = std::chrono::milliseconds{ 2 };
+    };
+
+    struct Result {
+        bool converged    = false;
+        size_t iterations = 0;
+        Targets totals    = {}; // Nutrients of the meal at the weights found
+    };
+
+    MealPlanner() = default;
+    explicit MealPlanner(std::span<const Candidate> candidates);
+
+    // Starts over with new foods, forgetting the last solution
+    void set_candidates(std::span<const Candidate> candidates);
+
+    // Stops early, with the best weights found so far, when it runs out of iterations or time
+    Result solve(const Targets& targets, const Options& options);
+
+    Result solve(const Targets& targets) {
+        return solve(targets, Options{});
+    }
+
+    [[nodiscard]] std::span<const double> weights() const noexcept {
+        return m_weights;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_weights.size();
+    }
+
+private:
+    using Matrix = std::array<Targets, target_count>;
+
+    struct Evaluation {
+        double value     = 0.0;
+        Targets gradient = {};
+        Matrix hessian   = {}; // Negated, so that it is positive definite
+    };
+
+    // Evaluates the dual at `dual`, and sets the weights to the ones that minimize the problem for it
+    Evaluation evaluate(const Targets& dual, const Targets& scaled_targets, const Targets& inverse_scales,
+        double regularization);
+
+private:
+    std::vector<std::array<double, target_count>> m_nutrients_per_gram;
+    std::vector<double> m_min_weights;
+    std::vector<double> m_max_weights;
+    std::vector<double> m_anchor_weights;
+    std::vector<double> m_weights;
+
+    Targets m_dual = {};
+};
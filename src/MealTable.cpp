@@ -0,0 +1,132 @@
+#include "MealTable.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "MemoryStats.h"
+#include "NutrientKernels.h"
+
+
+// The totals get recomputed exactly after this many incremental updates, or after as many as there are rows if that is
+// more, which keeps the cost of the recomputations at O(1) per update
+static constexpr size_t min_updates_per_recompute = 256;
+
+
+Food MealTable::row(const size_t row) const noexcept {
+    auto food = Food{ .id = m_ids[row] };
+    for (size_t column = 0; column < column_count; ++column) {
+        food.values[column] = m_columns[column][row];
+    }
+    return food;
+}
+
+void MealTable::set_row(const size_t row, const Food& food) noexcept {
+    m_ids[row] = food.id;
+    for (size_t column = 0; column < column_count; ++column) {
+        m_totals[column] += static_cast<double>(food.values[column]) - static_cast<double>(m_columns[column][row]);
+        m_columns[column][row] = food.values[column];
+    }
+    count_update();
+}
+
+void MealTable::reserve(const size_t row_count) {
+    MEMORY_TAG(MealModel);
+
+    m_ids.reserve(row_count);
+    for (auto& values : m_columns) {
+        values.reserve(row_count);
+    }
+}
+
+void MealTable::push_back(const Food& food) {
+    MEMORY_TAG(MealModel);
+
+    m_ids.push_back(food.id);
+    for (size_t column = 0; column < column_count; ++column) {
+        m_columns[column].push_back(food.values[column]);
+        m_totals[column] += static_cast<double>(food.values[column]);
+    }
+    count_update();
+}
+
+void MealTable::erase(const size_t row) {
+    MEMORY_TAG(MealModel);
+
+    const auto offset = static_cast<std::ptrdiff_t>(row);
+
+    m_ids.erase(m_ids.begin() + offset);
+    for (size_t column = 0; column < column_count; ++column) {
+        m_totals[column] -= static_cast<double>(m_columns[column][row]);
+        m_columns[column].erase(m_columns[column].begin() + offset);
+    }
+    count_update();
+}
+
+void MealTable::clear() noexcept {
+    m_ids.clear();
+    for (auto& values : m_columns) {
+        values.clear();
+    }
+
+    m_totals                  = {};
+    m_updates_since_recompute = 0;
+}
+
+void MealTable::recompute_totals() noexcept {
+    for (size_t column = 0; column < column_count; ++column) {
+        m_totals[column] = kernels::sum(m_columns[column]);
+    }
+    m_updates_since_recompute = 0;
+}
+
+void MealTable::begin_scale() {
+    MEMORY_TAG(MealModel);
+
+    for (size_t column = 0; column < column_count; ++column) {
+        m_scale_base[column].assign(m_columns[column].begin(), m_columns[column].end());
+    }
+
+    recompute_totals();
+    m_scale_base_totals = m_totals;
+    m_is_scaling        = true;
+    m_scale_factor      = 1.0f;
+}
+
+void MealTable::scale_total(const size_t column, const double total) {
+    // Rows might have been added or removed since the scale began, in which case the base is useless
+    if (!m_is_scaling || m_scale_base[column].size() != size()) {
+        begin_scale();
+    }
+
+    // A column that sums up to 0 can't be scaled to anything else
+    const auto base_total = m_scale_base_totals[column];
+    if (std::abs(base_total) < std::numeric_limits<double>::epsilon()) {
+        return;
+    }
+
+    const auto factor = total / base_total;
+    m_scale_factor    = static_cast<float>(factor);
+
+    for (size_t other = 0; other < column_count; ++other) {
+        kernels::scale(m_scale_base[other], m_scale_factor, m_columns[other]);
+        m_totals[other] = m_scale_base_totals[other] * factor;
+    }
+    m_totals[column] = total;
+}
+
+float MealTable::end_scale() noexcept {
+    if (!m_is_scaling) {
+        return 1.0f;
+    }
+
+    m_is_scaling = false;
+    recompute_totals();
+    return m_scale_factor;
+}
+
+void MealTable::count_update() noexcept {
+    m_updates_since_recompute += 1;
+    if (m_updates_since_recompute >= std::max(min_updates_per_recompute, size())) {
+        recompute_totals();
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <span>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include "Food.h"
+
+
+// The rows of a meal, stored column-wise: the ids of the foods in one array and every nutrient in its own contiguous
+// array of floats. Whole columns can then be summed and scaled by the vectorized `kernels` instead of visiting the rows
+// one by one.
+//
+// The totals of the columns are kept up to date incrementally, so editing a row costs the same however long the meal
+// is. They are tracked in double precision and recomputed exactly every so often, which keeps the rounding errors of
+// the updates from piling up.
+class MealTable {
+public:
+    static constexpr auto column_count = std::tuple_size_v<decltype(Food::values)>;
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_ids.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return m_ids.empty();
+    }
+
+    [[nodiscard]] std::span<const FoodId> ids() const noexcept {
+        return m_ids;
+    }
+
+    [[nodiscard]] std::span<const float> column(const size_t column) const noexcept {
+        return m_columns[column];
+    }
+
+    [[nodiscard]] std::span<float> column(const size_t column) noexcept {
+        return m_columns[column];
+    }
+
+    [[nodiscard]] Food row(size_t row) const noexcept;
+    void set_row(size_t row, const Food& food) noexcept;
+
+    void reserve(size_t row_count);
+    void push_back(const Food& food);
+    void erase(size_t row);
+    void clear() noexcept;
+
+    [[nodiscard]] const std::array<double, column_count>& totals() const noexcept {
+        return m_totals;
+    }
+
+    void recompute_totals() noexcept;
+
+    // Proportional rescaling of the whole table so that the total of `column` becomes `total`. Every call scales the
+    // table as it was on `begin_scale` rather than its current values, so a sequence of scales (like typing "0.5",
+    // which goes through 0 first) never compounds rounding errors or loses the table to a zero factor.
+    void begin_scale();
+    void scale_total(size_t column, double total);
+
+    // Returns the factor that the table ended up scaled by, relative to the table on `begin_scale`
+    float end_scale() noexcept;
+
+private:
+    void count_update() noexcept;
+
+private:
+    std::vector<FoodId> m_ids;
+    std::array<std::vector<float>, column_count> m_columns;
+
+    std::array<double, column_count> m_totals = {};
+    size_t m_updates_since_recompute          = 0;
+
+    bool m_is_scaling    = false;
+    float m_scale_factor = 1.0f;
+    std::array<std::vector<float>, column_count> m_scale_base;
+    std::array<double, column_count> m_scale_base_totals = {};
+};
@@ -0,0 +1,230 @@
+#include "MemoryStats.h"
+
+#include <new>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <fmt/color.h>
+
+
+namespace memory {
+namespace {
+
+// In front of every counted allocation, `offset` bytes after the start of the block that `malloc` returned
+struct Header {
+    uint64_t size   = 0;
+    uint32_t offset = 0;
+    Tag tag         = Tag::Other;
+};
+
+// Every tag on its own cache line, so that threads allocating under different tags don't contend
+struct alignas(64) Counters {
+    std::atomic<uint64_t> allocations     = 0;
+    std::atomic<uint64_t> frees           = 0;
+    std::atomic<uint64_t> allocated_bytes = 0;
+    std::atomic<uint64_t> live_bytes      = 0;
+    std::atomic<uint64_t> peak_live_bytes = 0;
+};
+
+// Constant initialized, since allocations can happen before any dynamic initialization did
+constinit std::array<Counters, tag_count> g_counters = {};
+constinit thread_local uint64_t t_allocations        = 0;
+
+Counters& counters(const Tag tag) noexcept {
+    const auto index = static_cast<size_t>(tag);
+    return g_counters[index < tag_count ? index : 0];
+}
+
+std::atomic<bool>& assertions() noexcept {
+    static auto enabled = std::atomic<bool>{ std::getenv("NT_ASSERT_ALLOCATIONS") != nullptr };
+    return enabled;
+}
+
+} // namespace
+
+
+Stats stats() noexcept {
+    auto result = Stats{};
+    for (size_t index = 0; index < tag_count; ++index) {
+        const auto& tag_counters  = g_counters[index];
+        auto& tag_stats           = result[index];
+        tag_stats.allocations     = tag_counters.allocations.load(std::memory_order_relaxed);
+        tag_stats.frees           = tag_counters.frees.load(std::memory_order_relaxed);
+        tag_stats.allocated_bytes = tag_counters.allocated_bytes.load(std::memory_order_relaxed);
+        tag_stats.live_bytes      = tag_counters.live_bytes.load(std::memory_order_relaxed);
+        tag_stats.peak_live_bytes = tag_counters.peak_live_bytes.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+uint64_t thread_allocation_count() noexcept {
+    return t_allocations;
+}
+
+void* allocate(const size_t size, const Tag tag, const size_t alignment) noexcept {
+    const auto header_alignment = std::max(alignment, alignof(Header));
+    if (size > SIZE_MAX - sizeof(Header) - header_alignment) {
+        return nullptr;
+    }
+
+    auto* block = std::malloc(size + sizeof(Header) + header_alignment - 1);
+    if (block == nullptr) {
+        return nullptr;
+    }
+
+    const auto start   = reinterpret_cast<uintptr_t>(block);
+    const auto address = (start + sizeof(Header) + header_alignment - 1) & ~(header_alignment - 1);
+    auto* header       = reinterpret_cast<Header*>(address - sizeof(Header));
+    *header            = { .size = size, .offset = static_cast<uint32_t>(address - start), .tag = tag };
+
+    auto& tag_counters = counters(tag);
+    tag_counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    tag_counters.allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    const auto live = tag_counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+    auto peak = tag_counters.peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !tag_counters.peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+
+    t_allocations += 1;
+    return reinterpret_cast<void*>(address);
+}
+
+void deallocate(void* pointer) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+
+    const auto address = reinterpret_cast<uintptr_t>(pointer);
+    const auto& header = *reinterpret_cast<const Header*>(address - sizeof(Header));
+    auto& tag_counters = counters(header.tag);
+    tag_counters.frees.fetch_add(1, std::memory_order_relaxed);
+    tag_counters.live_bytes.fetch_sub(header.size, std::memory_order_relaxed);
+
+    std::free(reinterpret_cast<void*>(address - header.offset));
+}
+
+AllocationLimit::AllocationLimit(const char* name, const uint64_t max_allocations) noexcept
+    : m_name(name)
+    , m_max_allocations(max_allocations)
+    , m_start_count(thread_allocation_count()) {}
+
+AllocationLimit::~AllocationLimit() {
+    const auto count = thread_allocation_count() - m_start_count;
+    if (count <= m_max_allocations) {
+        return;
+    }
+
+    fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: {} made {} allocations, more than the {} it is allowed\n",
+        m_name, count, m_max_allocations);
+    if (assertions_enabled()) {
+        std::abort();
+    }
+}
+
+void set_assertions(const bool enabled) noexcept {
+    assertions().store(enabled, std::memory_order_relaxed);
+}
+
+bool assertions_enabled() noexcept {
+    return assertions().load(std::memory_order_relaxed);
+}
+
+} // namespace memory
+
+
+#ifdef NT_ENABLE_ALLOCATION_TRACKING
+// Replacing these replaces them for the whole program, the standard library and every other library included. Every
+// form is replaced, rather than relying on the standard library to forward the others to these.
+namespace {
+
+void* allocate_or_throw(const size_t size, const size_t alignment) {
+    if (auto* pointer = memory::allocate(size, memory::t_tag, alignment)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+} // namespace
+
+void* operator new(const size_t size) {
+    return allocate_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new[](const size_t size) {
+    return allocate_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment) {
+    return allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](const size_t size, const std::align_val_t alignment) {
+    return allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(const size_t size, const std::nothrow_t& /*tag*/) noexcept {
+    return memory::allocate(size, memory::t_tag);
+}
+
+void* operator new[](const size_t size, const std::nothrow_t& /*tag*/) noexcept {
+    return memory::allocate(size, memory::t_tag);
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment, const std::nothrow_t& /*tag*/) noexcept {
+    return memory::allocate(size, memory::t_tag, static_cast<size_t>(alignment));
+}
+
+void* operator new[](const size_t size, const std::align_val_t alignment, const std::nothrow_t& /*tag*/) noexcept {
+    return memory::allocate(size, memory::t_tag, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t /*size*/) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t /*size*/) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t /*alignment*/) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t /*alignment*/) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t& /*tag*/) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t& /*tag*/) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t /*alignment*/, const std::nothrow_t& /*tag*/) noexcept {
+    memory::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t /*alignment*/, const std::nothrow_t& /*tag*/) noexcept {
+    memory::deallocate(pointer);
+}
+#endif
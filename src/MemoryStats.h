@@ -0,0 +1,114 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+using namespace std::literals;
+
+
+// Counts the heap allocations of the whole app by the subsystem that made them. Code tags its allocations for as long
+// as a scope lasts:
+//
+//     FuzzySearchIndex::FuzzySearchIndex(const std::span<const std::string_view> items) {
+//         MEMORY_TAG(Search);
+//         ...
+//     }
+//
+// Counting only happens in builds with `NT_ENABLE_ALLOCATION_TRACKING` defined. They replace the global `operator new`
+// and `operator delete`, and the app hands ImGui the same allocator, which puts a small header in front of every
+// allocation that remembers its size and tag until it is freed. Otherwise the macros expand to nothing, the stats stay
+// zero and allocating costs what it always does.
+#ifdef NT_ENABLE_ALLOCATION_TRACKING
+#define MEMORY_TAG_CONCAT_IMPL(a, b) a##b
+#define MEMORY_TAG_CONCAT(a, b) MEMORY_TAG_CONCAT_IMPL(a, b)
+#define MEMORY_TAG(tag) const auto MEMORY_TAG_CONCAT(memory_tag_, __LINE__) = memory::ScopedTag{ memory::Tag::tag }
+#else
+#define MEMORY_TAG(tag) static_cast<void>(0)
+#endif
+
+
+namespace memory {
+
+constexpr bool is_enabled =
+#ifdef NT_ENABLE_ALLOCATION_TRACKING
+    true;
+#else
+    false;
+#endif
+
+enum class Tag : uint8_t {
+    Other = 0,
+    Catalog,
+    Search,
+    MealModel,
+    ImGui,
+};
+
+constexpr auto tag_names = std::array{ "Other"sv, "Catalog"sv, "Search"sv, "Meal model"sv, "ImGui"sv };
+constexpr auto tag_count = tag_names.size();
+
+// Everything since the app started, the bytes don't include the headers
+struct TagStats {
+    uint64_t allocations     = 0;
+    uint64_t frees           = 0;
+    uint64_t allocated_bytes = 0;
+    uint64_t live_bytes      = 0;
+    uint64_t peak_live_bytes = 0;
+};
+
+using Stats = std::array<TagStats, tag_count>;
+
+[[nodiscard]] Stats stats() noexcept;
+
+// Allocations made by the calling thread so far, under any tag
+[[nodiscard]] uint64_t thread_allocation_count() noexcept;
+
+// Counted `malloc` and `free`. Returns nullptr when out of memory, `alignment` has to be a power of two.
+[[nodiscard]] void* allocate(size_t size, Tag tag, size_t alignment = alignof(std::max_align_t)) noexcept;
+void deallocate(void* pointer) noexcept;
+
+// The tag that the allocations of the calling thread get counted under
+inline thread_local Tag t_tag = Tag::Other;
+
+class ScopedTag {
+public:
+    explicit ScopedTag(const Tag tag) noexcept
+        : m_previous(t_tag) {
+        t_tag = tag;
+    }
+
+    ~ScopedTag() {
+        t_tag = m_previous;
+    }
+
+    ScopedTag(const ScopedTag&)            = delete;
+    ScopedTag& operator=(const ScopedTag&) = delete;
+
+private:
+    Tag m_previous;
+};
+
+// Guards code that must not allocate more than it used to, like a frame of an idle app or the inner loop of a
+// benchmark: reports when the calling thread made more than `max_allocations` allocations during the limit's lifetime.
+// With assertions enabled, it aborts instead, so that a test run fails on the regression. Does nothing in builds that
+// don't count allocations.
+class AllocationLimit {
+public:
+    AllocationLimit(const char* name, uint64_t max_allocations) noexcept;
+    ~AllocationLimit();
+
+    AllocationLimit(const AllocationLimit&)            = delete;
+    AllocationLimit& operator=(const AllocationLimit&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_max_allocations;
+    uint64_t m_start_count;
+};
+
+// Off unless the `NT_ASSERT_ALLOCATIONS` environment variable is set
+void set_assertions(bool enabled) noexcept;
+[[nodiscard]] bool assertions_enabled() noexcept;
+
+} // namespace memory
@@ -0,0 +1,109 @@
+#include "MemoryWindow.h"
+
+#include <algorithm>
+#include "imgui.h"
+#include "Application.h"
+
+
+namespace {
+
+const char* format_bytes(const uint64_t bytes) {
+    auto& arena = Application::frame_arena();
+    if (bytes < 1024) {
+        return arena.format("{} B", bytes);
+    }
+    if (bytes < 1024 * 1024) {
+        return arena.format("{:.1f} KiB", static_cast<double>(bytes) / 1024.0);
+    }
+    return arena.format("{:.1f} MiB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+}
+
+} // namespace
+
+
+void MemoryWindow::draw() {
+    if constexpr (!memory::is_enabled) {
+        ImGui::TextUnformatted(
+            "Allocation tracking is compiled out, configure with -DNT_ENABLE_ALLOCATION_TRACKING=ON to enable it");
+    } else {
+        collect();
+        draw_table();
+    }
+
+    ImGui::Separator();
+    draw_frame_arena();
+}
+
+// The window gets drawn once a frame, so whatever was allocated since it was last drawn is what the last frame did
+void MemoryWindow::collect() {
+    const auto stats = memory::stats();
+
+    if (m_has_stats) {
+        auto& total = m_last_frame.back();
+        total       = {};
+        for (size_t tag = 0; tag < memory::tag_count; ++tag) {
+            auto& frame       = m_last_frame[tag];
+            frame.allocations = stats[tag].allocations - m_stats[tag].allocations;
+            frame.bytes       = stats[tag].allocated_bytes - m_stats[tag].allocated_bytes;
+            total.allocations += frame.allocations;
+            total.bytes += frame.bytes;
+        }
+
+        for (size_t index = 0; index < m_last_frame.size(); ++index) {
+            auto& peak       = m_peak_frame[index];
+            peak.allocations = std::max(peak.allocations, m_last_frame[index].allocations);
+            peak.bytes       = std::max(peak.bytes, m_last_frame[index].bytes);
+        }
+    }
+
+    m_stats     = stats;
+    m_has_stats = true;
+}
+
+void MemoryWindow::draw_table() const {
+    constexpr auto column_names = std::array{ "Subsystem", "Frame allocations", "Frame bytes", "Most in a frame",
+        "Live", "Peak live" };
+    constexpr auto table_flags  = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+
+    if (!ImGui::BeginTable("##memory", static_cast<int>(column_names.size()), table_flags)) {
+        return;
+    }
+
+    for (const auto* name : column_names) {
+        ImGui::TableSetupColumn(name);
+    }
+    ImGui::TableHeadersRow();
+
+    const auto draw_row = [](const char* name, const FrameStats& frame, const FrameStats& peak, const char* live,
+                              const char* peak_live) {
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(name);
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(frame.allocations));
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(format_bytes(frame.bytes));
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu (%s)", static_cast<unsigned long long>(peak.allocations), format_bytes(peak.bytes));
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(live);
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(peak_live);
+    };
+
+    auto live_total = uint64_t{ 0 };
+    for (size_t tag = 0; tag < memory::tag_count; ++tag) {
+        draw_row(memory::tag_names[tag].data(), m_last_frame[tag], m_peak_frame[tag],
+            format_bytes(m_stats[tag].live_bytes), format_bytes(m_stats[tag].peak_live_bytes));
+        live_total += m_stats[tag].live_bytes;
+    }
+
+    // The subsystems peaked at different times, so their peaks don't add up to the peak of the whole app
+    draw_row("Total", m_last_frame.back(), m_peak_frame.back(), format_bytes(live_total), "");
+    ImGui::EndTable();
+}
+
+void MemoryWindow::draw_frame_arena() const {
+    const auto& arena = Application::frame_arena();
+    ImGui::Text("Frame arena: %s, frames used up to %s so far", format_bytes(arena.capacity()),
+        format_bytes(arena.high_water_mark()));
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "MemoryStats.h"
+
+
+// Allocations of every subsystem: how many the last frame made and how many bytes they asked for, the most that any
+// frame made so far, and how much memory every subsystem holds now and held at its peak. Also shows how much of the
+// frame arena the frames use.
+class MemoryWindow {
+public:
+    void draw();
+
+private:
+    struct FrameStats {
+        uint64_t allocations = 0;
+        uint64_t bytes       = 0;
+    };
+
+    void collect();
+    void draw_table() const;
+    void draw_frame_arena() const;
+
+private:
+    memory::Stats m_stats = {};
+    bool m_has_stats      = false;
+
+    // One per tag, then the total of the whole frame
+    std::array<FrameStats, memory::tag_count + 1> m_last_frame = {};
+    std::array<FrameStats, memory::tag_count + 1> m_peak_frame = {};
+};
@@ -0,0 +1,85 @@
+#include "NutrientKernels.h"
+
+#include <cassert>
+
+#if defined(__AVX__)
+#define NT_KERNELS_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NT_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+
+double kernels::sum(const std::span<const float> values) noexcept {
+    const auto* data = values.data();
+    const auto count = values.size();
+    auto index       = size_t{ 0 };
+    auto total       = 0.0;
+
+#if defined(NT_KERNELS_AVX)
+    auto low  = _mm256_setzero_pd();
+    auto high = _mm256_setzero_pd();
+    for (; index + 8 <= count; index += 8) {
+        const auto floats = _mm256_loadu_ps(data + index);
+        low               = _mm256_add_pd(low, _mm256_cvtps_pd(_mm256_castps256_ps128(floats)));
+        high              = _mm256_add_pd(high, _mm256_cvtps_pd(_mm256_extractf128_ps(floats, 1)));
+    }
+
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(low, high));
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(NT_KERNELS_SSE2)
+    auto low  = _mm_setzero_pd();
+    auto high = _mm_setzero_pd();
+    for (; index + 4 <= count; index += 4) {
+        const auto floats = _mm_loadu_ps(data + index);
+        low               = _mm_add_pd(low, _mm_cvtps_pd(floats));
+        high              = _mm_add_pd(high, _mm_cvtps_pd(_mm_movehl_ps(floats, floats)));
+    }
+
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(low, high));
+    total = lanes[0] + lanes[1];
+#endif
+
+    for (; index < count; ++index) {
+        total += static_cast<double>(data[index]);
+    }
+    return total;
+}
+
+void kernels::scale(const std::span<const float> values, const float factor, const std::span<float> out) noexcept {
+    assert(values.size() == out.size());
+
+    const auto* in   = values.data();
+    auto* result     = out.data();
+    const auto count = values.size();
+    auto index       = size_t{ 0 };
+
+#if defined(NT_KERNELS_AVX)
+    const auto factors = _mm256_set1_ps(factor);
+    for (; index + 8 <= count; index += 8) {
+        _mm256_storeu_ps(result + index, _mm256_mul_ps(_mm256_loadu_ps(in + index), factors));
+    }
+#elif defined(NT_KERNELS_SSE2)
+    const auto factors = _mm_set1_ps(factor);
+    for (; index + 4 <= count; index += 4) {
+        _mm_storeu_ps(result + index, _mm_mul_ps(_mm_loadu_ps(in + index), factors));
+    }
+#endif
+
+    for (; index < count; ++index) {
+        result[index] = in[index] * factor;
+    }
+}
+
+const char* kernels::instruction_set() noexcept {
+#if defined(NT_KERNELS_AVX)
+    return "AVX";
+#elif defined(NT_KERNELS_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
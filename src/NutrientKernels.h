@@ -0,0 +1,18 @@
+#pragma once
+#include <span>
+
+
+// Vectorized kernels over the nutrient columns of a `MealTable`. Builds targeting AVX use AVX, other x86 builds use
+// SSE2 and any other architecture falls back to plain loops.
+namespace kernels {
+
+// Accumulates in double precision, so that the total of thousands of rows doesn't drift from the exact one
+[[nodiscard]] double sum(std::span<const float> values) noexcept;
+
+// `out[i] = values[i] * factor`. `out` may be `values` itself, but must not overlap it in any other way.
+void scale(std::span<const float> values, float factor, std::span<float> out) noexcept;
+
+// Name of the instruction set the kernels were compiled for
+[[nodiscard]] const char* instruction_set() noexcept;
+
+} // namespace kernels
@@ -0,0 +1,286 @@
+#include <map>
+#include <span>
+#include <array>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iterator>
+#include <optional>
+#include <charconv>
+#include <algorithm>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fmt/std.h>
+#include <fmt/ranges.h>
+#include <nlohmann/json.hpp>
+#include "Meal.h"
+#include "MealDocument.h"
+#include "MealTable.h"
+#include "AtomicFile.h"
+#include "HistoryStore.h"
+#include "FoodCatalog.h"
+#include "ThreadPool.h"
+
+using namespace std::literals;
+
+
+// Computes the nutrient totals of saved meals without a display. Takes meal documents, binary or json (`MealDocument`,
+// like the snapshot `res/day0.meal`, and meals saved before it like `res/day0.json`), or directories to search for them.
+// `--export` converts every meal read into a single document, as json when the path ends in ".json".
+// Usage: nutrition_batch [--catalog database.bin] [--database database.json] [--threads count] [--csv totals.csv]
+//                        [--export meals.meal] <files or directories>...
+namespace {
+
+using Totals = std::array<double, MealTable::column_count>;
+
+constexpr auto column_names = std::array{ "protein"sv, "carbo"sv, "fat"sv, "calories"sv, "weight"sv };
+
+struct FileTotals {
+    bool is_valid                            = false;
+    size_t row_count                         = 0;
+    Totals totals                            = {};
+    std::map<std::string, Totals> day_totals = {}; // Of the meals that have a day
+    std::vector<DocumentMeal> meals          = {}; // Only kept when they get exported
+};
+
+struct Options {
+    std::filesystem::path binary_path              = "res/database.bin";
+    std::filesystem::path json_path                = "res/database.json";
+    std::filesystem::path csv_path                 = {};
+    std::filesystem::path export_path              = {};
+    size_t thread_count                            = 0;
+    std::vector<std::filesystem::path> input_paths = {};
+};
+
+FileTotals compute_file_totals(const std::filesystem::path& path, const FoodCatalog& food_catalog, const bool keep_meals) {
+    // A single malformed file must not take down a run over thousands of them, `load` reports it and goes on
+    auto document = MealDocument::load(path, food_catalog);
+    if (!document.has_value()) {
+        return {};
+    }
+
+    auto result = FileTotals{ .is_valid = true };
+    auto table  = MealTable{};
+    for (const auto& document_meal : document->meals) {
+        table.clear();
+        table.reserve(document_meal.meal.rows.size());
+        for (const auto& row : document_meal.meal.rows) {
+            table.push_back(row);
+        }
+        table.recompute_totals();
+
+        result.row_count += table.size();
+        for (size_t column = 0; column < result.totals.size(); ++column) {
+            result.totals[column] += table.totals()[column];
+            if (document_meal.day.has_value()) {
+                result.day_totals[format_day(*document_meal.day)][column] += table.totals()[column];
+            }
+        }
+    }
+
+    if (keep_meals) {
+        result.meals = std::move(document->meals);
+    }
+    return result;
+}
+
+// Expands directories into the meal documents inside of them, sorted so that runs over the same tree list the same order
+std::vector<std::filesystem::path> collect_files(const std::vector<std::filesystem::path>& input_paths) {
+    auto files = std::vector<std::filesystem::path>{};
+
+    for (const auto& input_path : input_paths) {
+        auto error = std::error_code{};
+        if (!std::filesystem::is_directory(input_path, error)) {
+            files.push_back(input_path);
+            continue;
+        }
+
+        auto directory_files = std::vector<std::filesystem::path>{};
+        for (auto it = std::filesystem::recursive_directory_iterator{ input_path, error };
+             !error && it != std::filesystem::recursive_directory_iterator{}; it.increment(error)) {
+            const auto extension = it->path().extension();
+            if (it->is_regular_file(error) && (extension == ".json" || extension == MealDocument::extension)) {
+                directory_files.push_back(it->path());
+            }
+        }
+        if (error) {
+            fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Could not list {}: {}\n", input_path, error.message());
+        }
+
+        std::ranges::sort(directory_files);
+        files.insert(files.end(), directory_files.begin(), directory_files.end());
+    }
+    return files;
+}
+
+std::string format_totals(const Totals& totals) {
+    auto out = std::string{};
+    for (size_t column = 0; column < totals.size(); ++column) {
+        out += fmt::format("{}{}: {:.1f}", column > 0 ? ", " : "", column_names[column], totals[column]);
+    }
+    return out;
+}
+
+bool write_csv(const std::filesystem::path& csv_path, std::span<const std::filesystem::path> files,
+    std::span<const FileTotals> results) {
+    auto out = fmt::format("path,day,rows,{}\n", fmt::join(column_names, ","));
+    for (size_t index = 0; index < files.size(); ++index) {
+        const auto& result = results[index];
+        if (!result.is_valid) {
+            continue;
+        }
+
+        // Quoted, since paths may contain commas
+        auto path = files[index].string();
+        for (auto position = path.find('"'); position != std::string::npos; position = path.find('"', position + 2)) {
+            path.insert(position, 1, '"');
+        }
+        // The day column stays empty for documents with meals of no or of several days
+        const auto day = result.day_totals.size() == 1 ? result.day_totals.begin()->first : ""s;
+        fmt::format_to(std::back_inserter(out), "\"{}\",{},{},{:.3f}\n", path, day, result.row_count,
+            fmt::join(result.totals, ","));
+    }
+    return atomic_write_file(csv_path, out);
+}
+
+std::optional<Options> parse_options(std::span<char*> args) {
+    auto options = Options{};
+
+    for (size_t index = 0; index < args.size(); ++index) {
+        const auto arg       = std::string_view{ args[index] };
+        const auto has_value = index + 1 < args.size();
+
+        if (arg == "--catalog" && has_value) {
+            options.binary_path = args[++index];
+        } else if (arg == "--database" && has_value) {
+            options.json_path = args[++index];
+        } else if (arg == "--csv" && has_value) {
+            options.csv_path = args[++index];
+        } else if (arg == "--export" && has_value) {
+            options.export_path = args[++index];
+        } else if (arg == "--threads" && has_value) {
+            const auto value        = std::string_view{ args[++index] };
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), options.thread_count);
+            if (error != std::errc{} || end != value.data() + value.size()) {
+                return std::nullopt;
+            }
+        } else if (arg.starts_with("--")) {
+            return std::nullopt;
+        } else {
+            options.input_paths.emplace_back(arg);
+        }
+    }
+
+    if (options.input_paths.empty()) {
+        return std::nullopt;
+    }
+    return options;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[]) {
+    const auto options = parse_options(std::span{ argv, static_cast<size_t>(argc) }.subspan(1));
+    if (!options.has_value()) {
+        fmt::print("Usage: nutrition_batch [--catalog database.bin] [--database database.json] [--threads count]\n"
+                   "                       [--csv totals.csv] [--export meals.meal] <meal files or directories>...\n");
+        return EXIT_FAILURE;
+    }
+
+    auto food_catalog = FoodCatalog::load(options->binary_path, options->json_path);
+    if (!food_catalog.has_value()) {
+        return EXIT_FAILURE;
+    }
+
+    const auto files = collect_files(options->input_paths);
+    const auto start = std::chrono::steady_clock::now();
+
+    // One task per file, the queue hands them out to whichever worker is free, so a few big files don't stall the rest
+    auto results          = std::vector<FileTotals>(files.size());
+    auto pool             = ThreadPool{ options->thread_count, "Batch" };
+    const auto keep_meals = !options->export_path.empty();
+    {
+        auto pending = std::vector<std::future<void>>{};
+        pending.reserve(files.size());
+        for (size_t index = 0; index < files.size(); ++index) {
+            pending.push_back(pool.submit([&, index] {
+                results[index] = compute_file_totals(files[index], *food_catalog, keep_meals);
+            }));
+        }
+        for (auto& future : pending) {
+            future.get();
+        }
+    }
+
+    const auto elapsed = std::chrono::duration<double>{ std::chrono::steady_clock::now() - start }.count();
+
+    // Meals of the same day add up into that day's totals
+    auto totals     = Totals{};
+    auto day_totals = std::map<std::string, Totals>{};
+    auto row_count  = size_t{ 0 };
+    auto failed     = size_t{ 0 };
+    for (const auto& result : results) {
+        if (!result.is_valid) {
+            failed += 1;
+            continue;
+        }
+
+        row_count += result.row_count;
+        for (size_t column = 0; column < totals.size(); ++column) {
+            totals[column] += result.totals[column];
+        }
+        for (const auto& [day, day_total] : result.day_totals) {
+            for (size_t column = 0; column < totals.size(); ++column) {
+                day_totals[day][column] += day_total[column];
+            }
+        }
+    }
+
+    fmt::print("[INFO]: Computed the totals of {} files ({} rows) in {:.1f}ms on {} threads ({:.0f} files/s)\n",
+        files.size() - failed, row_count, elapsed * 1000.0, pool.thread_count(),
+        static_cast<double>(files.size()) / std::max(elapsed, 1e-9));
+    fmt::print("Total: {}\n", format_totals(totals));
+
+    if (!day_totals.empty()) {
+        auto daily_means = Totals{};
+        for (const auto& [day, day_total] : day_totals) {
+            for (size_t column = 0; column < daily_means.size(); ++column) {
+                daily_means[column] += day_total[column] / static_cast<double>(day_totals.size());
+            }
+        }
+        fmt::print("Daily mean over {} days ({} to {}): {}\n", day_totals.size(), day_totals.begin()->first,
+            day_totals.rbegin()->first, format_totals(daily_means));
+    }
+
+    if (!options->csv_path.empty()) {
+        if (!write_csv(options->csv_path, files, results)) {
+            return EXIT_FAILURE;
+        }
+        fmt::print("[INFO]: Wrote the totals of every file to {}\n", options->csv_path);
+    }
+
+    if (!options->export_path.empty()) {
+        auto document = MealDocument{};
+        for (auto& result : results) {
+            std::ranges::move(result.meals, std::back_inserter(document.meals));
+        }
+
+        const auto as_json = options->export_path.extension() == ".json";
+        const auto written = as_json ? atomic_write_file(options->export_path, document.to_json(*food_catalog).dump())
+                                     : document.save(options->export_path, *food_catalog);
+        if (!written) {
+            return EXIT_FAILURE;
+        }
+        fmt::print("[INFO]: Exported {} meals to {}\n", document.meals.size(), options->export_path);
+    }
+
+    if (failed != 0) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: {} of {} files could not be read\n", failed, files.size());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,65 +1,70 @@
 #include "NutritionTracker.h"
 
-#include <fstream>
+#include <cmath>
+#include <algorithm>
 #include <fmt/format.h>
 #include <fmt/color.h>
 #include <fmt/ranges.h>
 #include <range/v3/view/enumerate.hpp>
 #include "imgui_combo_autoselect.h"
+#include "Profiler.h"
 
 
 // TODO: Fix `.clang-format` as to not have to override clang-format
 // clang-format off
-EditMealWidget::EditMealWidget(const std::shared_ptr<food_values_table_type>& food_values_table) {
-    const auto food_names = *food_values_table | views::transform([](auto&& pair) {
-        return std::forward<decltype(pair.first)>(pair.first);
-    });
-
-    m_food_values_table = food_values_table;
-    m_dropdown_data     = ImGui::ComboAutoSelectData{ { food_names.begin(), food_names.end() } };
+EditMealWidget::EditMealWidget(const std::shared_ptr<const FoodCatalog>& food_catalog,
+    const std::shared_ptr<const ImGui::ComboAutoSelectItems>& food_names, const std::shared_ptr<AutoSaver>& auto_saver)
+{
+    // The dropdown lists the foods in catalog order, so a dropdown index is also a `FoodId`
+    m_food_catalog = food_catalog;
+    m_auto_saver   = auto_saver;
+    m_dropdown_data.set_items(food_names);
 }
 
-EditMealWidget::EditMealWidget(const json& json_serial, const std::shared_ptr<food_values_table_type>& food_values_table)
-    : EditMealWidget(food_values_table)
+EditMealWidget::EditMealWidget(const MealSnapshot& meal, const std::shared_ptr<const FoodCatalog>& food_catalog,
+    const std::shared_ptr<const ImGui::ComboAutoSelectItems>& food_names, const std::shared_ptr<AutoSaver>& auto_saver)
+    : EditMealWidget(food_catalog, food_names, auto_saver)
 {
-    deserialize(json_serial);
+    restore(meal);
 }
 // clang-format on
 
-json EditMealWidget::serialize() {
-    auto result = json{};
-    for (const auto& row : m_rows) {
-        result["rows"].push_back(row);
-    }
+MealSnapshot EditMealWidget::snapshot() const {
+    auto result = MealSnapshot{ .title = m_title, .notes = m_notes };
+    result.rows.reserve(m_table.size());
 
-    result["title"] = m_title;
-    result["notes"] = m_notes;
+    for (const auto row_index : util::iota<size_t>(0, m_table.size())) {
+        result.rows.push_back(m_table.row(row_index));
+    }
     return result;
 }
 
-EditMealWidget& EditMealWidget::deserialize(const json& json_serial) {
-    if (json_serial.contains("rows")) {
-        m_rows.clear();
-        m_rows.reserve(json_serial.at("rows").size());
+json EditMealWidget::serialize() const {
+    return snapshot().to_json(*m_food_catalog);
+}
 
-        for (const auto& row : json_serial["rows"]) {
-            m_rows.push_back(row.get<Food>());
-        }
-        recalculate_total();
-    }
+EditMealWidget& EditMealWidget::deserialize(const json& json_serial) {
+    return restore(MealSnapshot::from_json(json_serial, *m_food_catalog));
+}
 
-    if (json_serial.contains("title")) {
-        json_serial["title"].get_to(m_title);
-    }
+EditMealWidget& EditMealWidget::restore(const MealSnapshot& meal) {
+    m_title = meal.title;
+    m_notes = meal.notes;
 
-    if (json_serial.contains("notes")) {
-        json_serial["notes"].get_to(m_notes);
+    m_table.clear();
+    m_table.reserve(meal.rows.size());
+    for (const auto& row : meal.rows) {
+        m_table.push_back(row);
     }
+    m_table.recompute_totals();
+    m_planner_bounds.clear();
 
     return *this;
 }
 
 void EditMealWidget::draw() {
+    PROFILE_FUNCTION();
+
     draw_text_input();
     ImGui::Separator();
     ImGui::NewLine();
@@ -72,9 +77,17 @@ void EditMealWidget::draw() {
     ImGui::EndGroup();
 
     draw_add_food_dropdown();
+    draw_planner();
 
-    if (ImGui::Button("Save")) {
-        std::ofstream("res/day0.json") << serialize();
+    // Edits get saved as they are made, this only folds them into a new snapshot of the meal
+    if (ImGui::Button("Save") && m_auto_saver != nullptr) {
+        m_auto_saver->save_now();
+    }
+}
+
+void EditMealWidget::record(MealEdit edit) {
+    if (m_auto_saver != nullptr) {
+        m_auto_saver->submit(std::move(edit));
     }
 }
 
@@ -120,18 +133,27 @@ static bool InputText(const std::string_view label, std::string& buffer, const I
 // clang-format on
 
 void EditMealWidget::draw_text_input() {
+    PROFILE_FUNCTION();
+
     const auto screen_width    = ImGui::GetContentRegionAvail().x;
     const auto min_input_width = ImGui::CalcTextSize("a").x * 30;
     const auto input_width     = std::max(std::min(min_input_width, screen_width), screen_width * 0.5f);
 
     // TODO: Change the title hint to the auto-generated title based on the time that will be used
     // if the user leaves this text input empty.
-    InputText("##meal_title", "Enter the title of this meal", m_title, ImVec2{ input_width, 0 });
-    InputText("##meal_notes", "Enter notes about this meal", m_notes, ImVec2{ input_width, ImGui::GetFontSize() * 6 },
-        ImGuiInputTextFlags_Multiline);
+    if (InputText("##meal_title", "Enter the title of this meal", m_title, ImVec2{ input_width, 0 })) {
+        record(MealEdit::set_title(m_title));
+    }
+
+    if (InputText("##meal_notes", "Enter notes about this meal", m_notes, ImVec2{ input_width, ImGui::GetFontSize() * 6 },
+            ImGuiInputTextFlags_Multiline)) {
+        record(MealEdit::set_notes(m_notes));
+    }
 }
 
 void EditMealWidget::draw_table() {
+    PROFILE_FUNCTION();
+
     constexpr auto column_names = std::array{ "Food"sv, "Protein"sv, "Carbo"sv, "Fat"sv, "Calories"sv, "Weight"sv };
     constexpr auto table_flags  = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable |
         ImGuiTableFlags_Reorderable | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_NoHostExtendX;
@@ -147,13 +169,9 @@ void EditMealWidget::draw_table() {
         ImGui::TableHeadersRow();
         reset_ids();
 
-        bool table_edited = false;
-        for (auto&& row : m_rows) {
-            table_edited |= draw_value_row(row);
-        }
-
-        if (table_edited) {
-            recalculate_total();
+        // Edited rows update the totals themselves
+        for (const auto row_index : util::iota<size_t>(0, m_table.size())) {
+            draw_value_row(row_index);
         }
 
         draw_total_row();
@@ -163,18 +181,24 @@ void EditMealWidget::draw_table() {
 }
 
 void EditMealWidget::draw_remove_buttons() {
+    PROFILE_FUNCTION();
+
     ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2{ FLT_MAX, 0.0f });
     ImGui::PushStyleVar(ImGuiStyleVar_CellPadding, ImVec2{ 0.0f, 0.0f });
 
     // Use up the height of the table header
     ImGui::Dummy(ImVec2{ 0.0f, ImGui::GetTextLineHeightWithSpacing() });
 
-    for (const auto& row_index : util::iota<int>(0, m_rows.size())) {
+    for (const auto& row_index : util::iota<int>(0, m_table.size())) {
         ImGui::PushID(row_index);
         ImGui::TableNextColumn();
 
         if (ImGui::Button("x")) {
-            m_rows.erase(m_rows.begin() + row_index);
+            m_table.erase(static_cast<size_t>(row_index));
+            if (static_cast<size_t>(row_index) < m_planner_bounds.size()) {
+                m_planner_bounds.erase(m_planner_bounds.begin() + row_index);
+            }
+            record(MealEdit::remove_row(static_cast<size_t>(row_index)));
         }
         ImGui::PopID();
     }
@@ -183,18 +207,24 @@ void EditMealWidget::draw_remove_buttons() {
 }
 
 void EditMealWidget::draw_add_food_dropdown() {
+    PROFILE_FUNCTION();
+
     if (ImGui::ComboAutoSelect("Add food", m_dropdown_data) && m_dropdown_data.index != -1) {
-        m_rows.push_back({
-            .name = m_dropdown_data.input,
-        });
+        const auto row = Food{
+            .id = FoodCatalog::id_at(static_cast<size_t>(m_dropdown_data.index)),
+        };
+        m_table.push_back(row);
+        record(MealEdit::add_row(row));
     }
 }
 
-bool EditMealWidget::draw_value_row(Food& row) {
+bool EditMealWidget::draw_value_row(const size_t row_index) {
     bool table_edited = false;
+    auto row          = m_table.row(row_index);
 
     next_column([&] {
         if (ImGui::ComboAutoSelect("##food_dropdown", m_dropdown_data) && m_dropdown_data.index != -1) {
+            row.id = FoodCatalog::id_at(static_cast<size_t>(m_dropdown_data.index));
             ranges::fill(row.values, 0.0f);
             table_edited |= true;
         }
@@ -203,7 +233,7 @@ bool EditMealWidget::draw_value_row(Food& row) {
     for (auto&& [index, value] : row.values | views::enumerate) {
         next_column([&] {
             if (ImGui::DragFloat("##grams_input", &value, 1.0f, 0.0f, 10'000.0f, "%.1fg")) {
-                const auto& food_props = (*m_food_values_table)[row.name];
+                const auto& food_props = m_food_catalog->props(row.id);
                 const auto weight      = food_props.get_weight_from_value(index, value);
 
                 // clang-format off
@@ -220,10 +250,16 @@ bool EditMealWidget::draw_value_row(Food& row) {
         });
     }
 
+    if (table_edited) {
+        m_table.set_row(row_index, row);
+        record(MealEdit::set_row(row_index, row));
+    }
     return table_edited;
 }
 
 void EditMealWidget::draw_total_row() {
+    PROFILE_FUNCTION();
+
     // TODO: Make this row be fixed when adding scrolling to the table. Maybe even make it a different color
 
     next_column([&] {
@@ -231,42 +267,125 @@ void EditMealWidget::draw_total_row() {
         // That on its own isn't all that bad but I hate seeing the cursor blinking. I think
         // `ImGui::Text` should be the best option if I can set the background to be blue.
 
-        // ImGui::TextUnformatted(total_row.name.c_str());
-        // ImGui::Selectable(total_row.name.c_str(), true);
-        ImGui::InputText("##total_row_name", m_total_row.name.data(), m_total_row.name.size(), ImGuiInputTextFlags_ReadOnly);
+        // ImGui::TextUnformatted("Total");
+        // ImGui::Selectable("Total", true);
+        static auto total_row_name = std::array<char, 6>{ "Total" };
+        ImGui::InputText("##total_row_name", total_row_name.data(), total_row_name.size(), ImGuiInputTextFlags_ReadOnly);
     });
 
-    for (auto&& value : m_total_row.values) {
+    for (const auto index : util::iota<size_t>(0, MealTable::column_count)) {
         next_column([&] {
-            // HACK: ImGui::DragFloat is triggered on every input change. This is the desired behavior for drag
-            // input but for key input, if you would enter something like `0.5`, this would be triggered first
-            // for just the `0` and thus it would multiply the whole table by 0.
-            // For now I fixed this by forcing a minimum input value, but this still could end up multiplying
-            // by a small value then by something really small then by something bigger, thus loosing precision.
-
-            auto prev_value = value;
-            if (ImGui::DragFloat("##grams_input", &value, 1.0f, 0.1f, 10'000.0f, "%.1fg")) {
-                // Guard for division by zero
-                if (std::abs(prev_value) < std::numeric_limits<float>::epsilon()) {
-                    value = 0.0f;
-                    return;
+            // NOTE: ImGui::DragFloat is triggered on every input change, so entering something like `0.5` first
+            // scales the table to `0`. Every change scales the table as it was when the edit began, so that
+            // intermediate values like this one, and the rounding of the ones before them, are simply forgotten.
+            // Likewise, only the final scale gets recorded.
+            auto value        = static_cast<float>(m_table.totals()[index]);
+            const auto edited = ImGui::DragFloat("##grams_input", &value, 1.0f, 0.0f, 10'000.0f, "%.1fg");
+
+            if (ImGui::IsItemActivated()) {
+                m_table.begin_scale();
+            }
+            if (edited) {
+                m_table.scale_total(index, static_cast<double>(value));
+            }
+            if (ImGui::IsItemDeactivated()) {
+                if (const auto factor = m_table.end_scale(); factor != 1.0f) {
+                    record(MealEdit::scale_rows(factor));
                 }
+            }
+        });
+    }
+}
 
-                // clang-format off
-                auto row_values = m_total_row.values
-                    | views::filter([&](const auto& other_value) { return &value != &other_value; });
+void EditMealWidget::draw_planner() {
+    PROFILE_FUNCTION();
 
-                auto table_values = m_rows
-                    | views::transform([](Food& food) -> auto& { return food.values; })
-                    | views::join;
-                // clang-format on
+    constexpr auto weight_limit = 10'000.0f;
 
-                for (auto&& other_value : views::concat(table_values, row_values)) {
-                    other_value *= value / prev_value;
-                }
-            }
+    if (!ImGui::CollapsingHeader("Planner")) {
+        return;
+    }
+
+    // Rows keep their bounds when other rows get removed, new rows may have any weight
+    m_planner_bounds.resize(m_table.size(), { 0.0f, weight_limit });
+
+    if (!m_planner_targets.has_value() || ImGui::Button("Use the current totals")) {
+        m_planner_targets.emplace();
+        std::copy_n(m_table.totals().begin(), m_planner_targets->size(), m_planner_targets->begin());
+    }
+
+    auto& targets = *m_planner_targets;
+    for (const auto index : util::iota<size_t>(0, targets.size())) {
+        auto value        = static_cast<float>(targets[index]);
+        const auto edited = ImGui::DragFloat(Food::value_names[index].data(), &value, 1.0f, 0.0f, 10'000.0f, "%.1fg");
+
+        if (ImGui::IsItemActivated()) {
+            begin_planning();
+        }
+        if (edited) {
+            targets[index] = static_cast<double>(value);
+            plan();
+        }
+        if (ImGui::IsItemDeactivated()) {
+            end_planning();
+        }
+    }
+
+    // The closest weights may still miss targets that the foods can't add up to, or that their bounds rule out
+    if (m_planner.size() > 0) {
+        auto largest_error = 0.0;
+        for (const auto index : util::iota<size_t>(0, targets.size())) {
+            const auto error = std::abs(m_planner_result.totals[index] - targets[index]) / std::max(targets[index], 1.0);
+            largest_error    = std::max(largest_error, error);
+        }
+        if (largest_error > 0.01) {
+            ImGui::Text("The closest weights are off the targets by up to %.0f%%", largest_error * 100.0);
+        }
+    }
+
+    for (const auto row_index : util::iota<size_t>(0, m_table.size())) {
+        auto& [min_weight, max_weight] = m_planner_bounds[row_index];
+
+        ImGui::PushID(static_cast<int>(row_index));
+        ImGui::DragFloatRange2(m_food_catalog->c_name(m_table.ids()[row_index]), &min_weight, &max_weight, 1.0f, 0.0f,
+            weight_limit, "Min: %.0fg", "Max: %.0fg", ImGuiSliderFlags_AlwaysClamp);
+        ImGui::PopID();
+    }
+}
+
+void EditMealWidget::begin_planning() {
+    auto candidates = std::pmr::vector<MealPlanner::Candidate>{ &Application::frame_arena() };
+    candidates.reserve(m_table.size());
+    for (const auto row_index : util::iota<size_t>(0, m_table.size())) {
+        const auto [min_weight, max_weight] = m_planner_bounds[row_index];
+        candidates.push_back({
+            .props      = m_food_catalog->props(m_table.ids()[row_index]),
+            .weight     = m_table.column(Food::Weight)[row_index],
+            .min_weight = min_weight,
+            .max_weight = max_weight,
         });
     }
+    m_planner.set_candidates(candidates);
+}
+
+void EditMealWidget::plan() {
+    // Whatever the solver didn't get to within its share of the frame, it continues with on the next one
+    m_planner_result = m_planner.solve(*m_planner_targets);
+
+    for (auto&& [row_index, weight] : m_planner.weights() | util::enumerate<size_t>) {
+        auto row               = m_table.row(row_index);
+        const auto& food_props = m_food_catalog->props(row.id);
+        for (auto&& [index, value] : row.values | views::enumerate) {
+            value = food_props.get_value_from_weight(index, static_cast<float>(weight));
+        }
+        m_table.set_row(row_index, row);
+    }
+}
+
+void EditMealWidget::end_planning() {
+    for (const auto row_index : util::iota<size_t>(0, m_planner.size())) {
+        record(MealEdit::set_row(row_index, m_table.row(row_index)));
+    }
 }
 
 void EditMealWidget::reset_ids() {
@@ -282,44 +401,267 @@ void EditMealWidget::next_column(auto&& func) {
     ImGui::PopID();
 }
 
-void EditMealWidget::recalculate_total() {
-    ranges::fill(m_total_row.values, 0.0f);
+// The nutrients that the history graph can show, and the units of their values
+static constexpr auto history_column_names = std::array{ "Protein", "Carbo", "Fat", "Calories", "Weight" };
+static constexpr auto history_column_units = std::array{ "g", "g", "g", "kcal", "g" };
+
+HistoryGraphWidget::HistoryGraphWidget(const std::shared_ptr<const HistoryStore>& history)
+    : m_history(history) {}
+
+void HistoryGraphWidget::reload() {
+    PROFILE_FUNCTION();
 
-    for (const auto& row : m_rows) {
-        for (const auto& index : views::iota(0u, row.values.size())) {
-            m_total_row.values[index] += row.values[index];
+    m_loaded_revision = m_history->revision();
+
+    const auto range = m_history->date_range();
+    if (!range.has_value()) {
+        m_series = {};
+        return;
+    }
+
+    const auto [first, last] = *range;
+    const auto day_count     = static_cast<size_t>((last - first).count()) + 1;
+    const auto is_first_load = m_series.front().size() == 0;
+
+    constexpr auto columns = std::array<size_t, MealTable::column_count>{ 0, 1, 2, 3, 4 };
+    m_history->load_totals(first, last, columns, m_totals);
+
+    // Days without any meal are gaps rather than zeroes
+    auto samples = std::vector<float>(day_count);
+    for (const auto column : columns) {
+        ranges::fill(samples, NAN);
+        for (const auto index : util::iota<size_t>(0, m_totals.keys.size())) {
+            auto& sample = samples[static_cast<size_t>((m_totals.keys[index].day - first).count())];
+            sample       = (std::isnan(sample) ? 0.0f : sample) + m_totals.columns[column][index];
         }
+        m_series[column] = LodSeries{ samples };
+    }
+
+    // Opens on the last three months, and keeps showing the same days when reloading
+    const auto shift = static_cast<double>((m_first_day - first).count());
+    m_first_day      = first;
+    if (is_first_load) {
+        m_view_last  = static_cast<double>(day_count);
+        m_view_first = std::max(0.0, m_view_last - 90.0);
+    } else {
+        m_view_first += shift;
+        m_view_last += shift;
     }
 }
 
-NutritionTracker::NutritionTracker() {
-    auto food_json = json::parse(std::ifstream{ "res/database.json" });
+void HistoryGraphWidget::draw() {
+    PROFILE_FUNCTION();
 
-    for (const auto& [food_name, json_props] : food_json.items()) {
-        auto is_valid   = (json_props.size() == Food::value_names.size());
-        auto food_props = FoodProps{};
+    if (m_history == nullptr) {
+        return;
+    }
+    if (m_loaded_revision != m_history->revision()) {
+        reload();
+    }
 
-        for (auto&& [index, name] : Food::value_names | views::enumerate) {
-            is_valid &= (json_props.contains(name) && json_props[name].is_number());
-            if (!is_valid) {
-                break;
-            }
-            food_props.props[index] = json_props[name].get<float>();
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("a").x * 20);
+    ImGui::Combo("Nutrient", &m_column, history_column_names.data(), static_cast<int>(history_column_names.size()));
+
+    const auto& series = m_series[static_cast<size_t>(m_column)];
+    if (series.size() == 0) {
+        ImGui::TextUnformatted("No meals saved yet");
+        return;
+    }
+
+    // The averages come out of the history's rollup rather than out of the series
+    const auto view_day = [&](const double offset) {
+        return m_first_day + std::chrono::days{ static_cast<int>(std::floor(offset)) };
+    };
+    const auto first_day = view_day(std::max(m_view_first, 0.0));
+    const auto last_day  = view_day(std::max(m_view_last - 1.0, 0.0));
+    const auto totals    = m_history->range_totals(first_day, last_day);
+
+    const auto column = static_cast<size_t>(m_column);
+    ImGui::Text("%s to %s, %u days logged, %.1f%s per day on average", format_day(first_day).c_str(),
+        format_day(last_day).c_str(), totals.logged_days, totals.daily_means()[column], history_column_units[column]);
+
+    draw_graph(series);
+}
+
+void HistoryGraphWidget::draw_graph(const LodSeries& series) {
+    const auto size = ImVec2{ ImGui::GetContentRegionAvail().x, ImGui::GetFontSize() * 12 };
+    if (size.x < 1.0f) {
+        return;
+    }
+
+    const auto origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("##history_graph", size);
+
+    // Zooming keeps the day under the mouse in place, and never zooms in past a week or out past the whole history
+    const auto& io       = ImGui::GetIO();
+    const auto day_count = static_cast<double>(series.size());
+    auto view_width      = m_view_last - m_view_first;
+    const auto mouse_day = m_view_first + static_cast<double>((io.MousePos.x - origin.x) / size.x) * view_width;
+
+    if (ImGui::IsItemHovered() && io.MouseWheel != 0.0f) {
+        const auto zoom = std::pow(0.8, static_cast<double>(io.MouseWheel));
+        view_width      = std::clamp(view_width * zoom, 7.0, std::max(day_count, 7.0));
+        m_view_first    = mouse_day - (mouse_day - m_view_first) * view_width / (m_view_last - m_view_first);
+        m_view_last     = m_view_first + view_width;
+    }
+    if (ImGui::IsItemActive()) {
+        const auto pan = -static_cast<double>(io.MouseDelta.x / size.x) * view_width;
+        m_view_first += pan;
+        m_view_last += pan;
+    }
+
+    // About one bucket per pixel, whatever the zoom
+    const auto first_sample = static_cast<size_t>(std::clamp(std::floor(m_view_first), 0.0, day_count));
+    const auto last_sample  = static_cast<size_t>(std::clamp(std::ceil(m_view_last), 0.0, day_count));
+    const auto level_index  = series.pick_level(first_sample, last_sample, static_cast<size_t>(size.x));
+    const auto level        = series.level(level_index);
+    const auto per_bucket   = LodSeries::samples_per_bucket(level_index);
+    const auto bucket_width = static_cast<double>(per_bucket);
+
+    const auto first_bucket = std::min(first_sample / per_bucket, level.size());
+    const auto last_bucket  = std::clamp((last_sample + per_bucket - 1) / per_bucket, first_bucket, level.size());
+    const auto buckets      = level.subspan(first_bucket, last_bucket - first_bucket);
+    const auto hover_radius = size.x / (2.0f * static_cast<float>(std::max(buckets.size(), size_t{ 1 })));
+
+    auto top = 0.0f;
+    for (const auto& bucket : buckets) {
+        top = bucket.count != 0 ? std::max(top, bucket.max) : top;
+    }
+    top = top > 0.0f ? top * 1.1f : 1.0f;
+
+    const auto to_screen = [&](const double sample, const float value) {
+        const auto x = origin.x + static_cast<float>((sample - m_view_first) / view_width) * size.x;
+        return ImVec2{ x, origin.y + size.y * (1.0f - value / top) };
+    };
+
+    auto* draw_list      = ImGui::GetWindowDrawList();
+    const auto end       = ImVec2{ origin.x + size.x, origin.y + size.y };
+    const auto line      = ImGui::GetColorU32(ImGuiCol_PlotLines);
+    const auto range_bar = ImGui::GetColorU32(ImGuiCol_PlotLines, 0.35f);
+
+    draw_list->AddRectFilled(origin, end, ImGui::GetColorU32(ImGuiCol_FrameBg));
+    draw_list->PushClipRect(origin, end, true);
+
+    // The min/max of every bucket as a bar behind the line of the means, which breaks at days without meals
+    auto means = std::pmr::vector<ImVec2>{ &Application::frame_arena() };
+    means.reserve(buckets.size());
+    const auto flush_means = [&] {
+        draw_list->AddPolyline(means.data(), static_cast<int>(means.size()), line, ImDrawFlags_None, 1.5f);
+        means.clear();
+    };
+
+    auto hovered = std::optional<std::pair<size_t, LodBucket>>{};
+    for (const auto offset : util::iota<size_t>(0, buckets.size())) {
+        const auto& bucket = buckets[offset];
+        if (bucket.count == 0) {
+            flush_means();
+            continue;
         }
 
-        if (!is_valid) {
-            fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: Invalid json format inside the node '{}'\n", food_name);
-            return;
+        const auto center = (static_cast<double>(first_bucket + offset) + 0.5) * bucket_width;
+        const auto low    = to_screen(center, bucket.min);
+        const auto high   = to_screen(center, bucket.max);
+        if (high.y < low.y) {
+            draw_list->AddLine(low, high, range_bar, std::max(1.0f, hover_radius * 2.0f));
         }
+        means.push_back(to_screen(center, bucket.mean));
 
-        m_food_values_table->emplace(food_name, food_props);
+        if (ImGui::IsItemHovered() && std::abs(io.MousePos.x - means.back().x) <= hover_radius) {
+            hovered = std::pair{ first_bucket + offset, bucket };
+        }
     }
+    flush_means();
+    draw_list->PopClipRect();
+
+    if (hovered.has_value()) {
+        const auto& [bucket_index, bucket] = *hovered;
+        const auto bucket_first = m_first_day + std::chrono::days{ static_cast<int>(bucket_index * bucket_width) };
+        const auto bucket_last  = bucket_first + std::chrono::days{ static_cast<int>(bucket_width) - 1 };
+
+        const auto* unit = history_column_units[static_cast<size_t>(m_column)];
+        const auto mean  = static_cast<double>(bucket.mean);
+        if (bucket_width == 1.0) {
+            ImGui::SetTooltip("%s: %.1f%s", format_day(bucket_first).c_str(), mean, unit);
+        } else {
+            ImGui::SetTooltip("%s to %s\nmean %.1f%s, min %.1f%s, max %.1f%s", format_day(bucket_first).c_str(),
+                format_day(bucket_last).c_str(), mean, unit, static_cast<double>(bucket.min), unit,
+                static_cast<double>(bucket.max), unit);
+        }
+    }
+}
 
-    // NOTE: The `EditMealWidget` constructor needs the finalized food hash table because it creates a copy of it's keys
-    m_edit_meal_widget = EditMealWidget{ json::parse(std::ifstream{ "res/day0.json" }), m_food_values_table };
+static const auto snapshot_path = std::filesystem::path{ "res/day0.meal" };
+static const auto journal_path  = std::filesystem::path{ "res/day0.journal" };
+
+NutritionTracker::NutritionTracker()
+    : m_loading_start_time(clock::now()) {
+    // Nothing but the loaded state is shared with the UI thread, which takes it over in one go once it is complete
+    m_loading = std::async(std::launch::async, [] {
+        PROFILE_THREAD("Loader");
+        auto loaded = load();
+        Application::wake();
+        return loaded;
+    });
+}
+
+NutritionTracker::LoadedState NutritionTracker::load() {
+    PROFILE_FUNCTION();
+
+    // The compiled catalog is memory mapped as it is, the json database is only parsed (and compiled again) when the
+    // catalog is stale
+    auto food_catalog = FoodCatalog::load("res/database.bin", "res/database.json");
+
+    auto result         = LoadedState{};
+    result.food_catalog = std::make_shared<const FoodCatalog>(
+        food_catalog.has_value() ? std::move(*food_catalog) : FoodCatalog{});
+
+    // Every meal editor's dropdown lists the names straight out of the catalog, and shares one search index over them
+    result.food_names = std::make_shared<const ImGui::ComboAutoSelectItems>(
+        result.food_catalog, result.food_catalog->name_pool(), result.food_catalog->name_offsets());
+
+    // Every meal ever saved lives in the history. Today's meal is additionally saved as a snapshot plus a journal of
+    // the edits made since, both get replayed on startup.
+    result.history   = std::make_shared<HistoryStore>("res/history");
+    result.recovered = AutoSaver::recover(snapshot_path, journal_path, *result.history, *result.food_catalog);
+    return result;
+}
+
+void NutritionTracker::finish_loading(LoadedState loaded) {
+    PROFILE_FUNCTION();
+
+    m_food_catalog  = std::move(loaded.food_catalog);
+    m_food_names    = std::move(loaded.food_names);
+    m_history       = std::move(loaded.history);
+    const auto meal = loaded.recovered.meal;
+
+    // The history graph has to be redrawn once a meal has been stored, even if nothing else happens
+    m_auto_saver = std::make_shared<AutoSaver>(snapshot_path, journal_path, m_history, m_food_catalog,
+        std::move(loaded.recovered), [] { Application::wake(); });
+    m_edit_meal_widget     = EditMealWidget{ meal, m_food_catalog, m_food_names, m_auto_saver };
+    m_history_graph_widget = HistoryGraphWidget{ m_history };
+
+    const auto elapsed_time = std::chrono::duration<double>{ clock::now() - m_loading_start_time };
+    fmt::print("[INFO]: Loaded {} foods and today's meal in the background in {:.1f}ms\n", m_food_catalog->size(),
+        elapsed_time.count() * 1000.0);
+}
+
+void NutritionTracker::draw_loading() const {
+    // Animated dots show that the app didn't hang, even when loading a big database takes a while
+    const auto elapsed_time = std::chrono::duration<double>{ clock::now() - m_loading_start_time };
+    const auto dot_count    = static_cast<int>(elapsed_time.count() * 3.0) % 4;
+    ImGui::TextDisabled("Loading the food database%.*s", dot_count, "...");
+    Application::request_frame(std::chrono::milliseconds{ 333 });
 }
 
 void NutritionTracker::on_update(double /*dt*/) {
+    PROFILE_FUNCTION();
+
+    // The loader wakes the UI up when it is done, so this gets checked right away
+    if (m_loading.valid() && m_loading.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready) {
+        finish_loading(m_loading.get());
+    }
+    const auto is_loading = m_loading.valid();
+
     // TODO: Make windows pop out
     // TODO: Add DPI awareness
     ImGui::DockSpaceOverViewport(ImGui::GetMainViewport());
@@ -328,7 +670,27 @@ void NutritionTracker::on_update(double /*dt*/) {
     ImGui::ShowDemoWindow(&show_demo_window);
 
     ImGui::Begin("Meal Window");
-    m_edit_meal_widget.draw();
+    if (is_loading) {
+        draw_loading();
+    } else {
+        m_edit_meal_widget.draw();
+    }
+    ImGui::End();
+
+    ImGui::Begin("History");
+    if (is_loading) {
+        draw_loading();
+    } else {
+        m_history_graph_widget.draw();
+    }
+    ImGui::End();
+
+    ImGui::Begin("Profiler");
+    m_profiler_window.draw();
+    ImGui::End();
+
+    ImGui::Begin("Memory");
+    m_memory_window.draw();
     ImGui::End();
 }
 
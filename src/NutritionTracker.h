@@ -1,98 +1,139 @@
 #pragma once
+#include <future>
 #include <optional>
-#include <unordered_map>
 #include <range/v3/all.hpp>
 #include <nlohmann/json.hpp>
+#include "Food.h"
+#include "Meal.h"
 #include "Utils.h"
+#include "MealTable.h"
+#include "MealPlanner.h"
+#include "LodSeries.h"
+#include "AutoSaver.h"
+#include "HistoryStore.h"
+#include "FoodCatalog.h"
 #include "Application.h"
+#include "ProfilerWindow.h"
+#include "MemoryWindow.h"
 #include "imgui_combo_autoselect.h"
 
 using json = nlohmann::json;
 
 
-struct Food {
-    std::string name;
-    std::array<float, 5> values = { 0.0f };
-
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Food, name, values)
-
-    static constexpr auto value_names = std::array{ "protein"sv, "carbo"sv, "fat"sv, "calories"sv };
-
-    enum ValueIndex : size_t {
-        Protein = 0,
-        Carbo,
-        Fat,
-        Calories,
-        Weight
-    };
-};
-
-
-struct FoodProps {
-    std::array<float, 5> props = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
-
-    [[nodiscard]] constexpr float get_value_from_weight(const Food::ValueIndex value, const float weight) const noexcept {
-        return (weight * props[value] / props[Food::Weight]);
-    }
-
-    [[nodiscard]] constexpr float get_value_from_weight(const size_t value_index, const float weight) const noexcept {
-        return get_value_from_weight(static_cast<Food::ValueIndex>(value_index), weight);
-    }
-
-    [[nodiscard]] constexpr float get_weight_from_value(const Food::ValueIndex value, const float weight) const noexcept {
-        return (weight * props[Food::Weight] / props[value]);
-    }
-
-    [[nodiscard]] constexpr float get_weight_from_value(const size_t value_index, const float weight) const noexcept {
-        return get_weight_from_value(static_cast<Food::ValueIndex>(value_index), weight);
-    }
-};
-
-using food_values_table_type = std::unordered_map<std::string, FoodProps>;
-
 class EditMealWidget {
 public:
     EditMealWidget() = default;
-    EditMealWidget(const std::shared_ptr<food_values_table_type>& food_values_table);
-    EditMealWidget(const json& json_serial, const std::shared_ptr<food_values_table_type>& food_values_table);
+    // `food_names` have to list the names of `food_catalog` in id order
+    EditMealWidget(const std::shared_ptr<const FoodCatalog>& food_catalog,
+        const std::shared_ptr<const ImGui::ComboAutoSelectItems>& food_names, const std::shared_ptr<AutoSaver>& auto_saver);
+    EditMealWidget(const MealSnapshot& meal, const std::shared_ptr<const FoodCatalog>& food_catalog,
+        const std::shared_ptr<const ImGui::ComboAutoSelectItems>& food_names, const std::shared_ptr<AutoSaver>& auto_saver);
 
     void draw();
-    [[nodiscard]] json serialize();
+    [[nodiscard]] MealSnapshot snapshot() const;
+    [[nodiscard]] json serialize() const;
     EditMealWidget& deserialize(const json& json_serial);
+    EditMealWidget& restore(const MealSnapshot& meal);
 
 private:
     void draw_text_input();
     void draw_table();
     void draw_remove_buttons();
     void draw_add_food_dropdown();
+    void draw_planner();
 
-    bool draw_value_row(Food& row);
+    bool draw_value_row(size_t row_index);
     void draw_total_row();
 
+    // Dragging a target of the planner solves for the weights of the rows every frame, and records them once it ends
+    void begin_planning();
+    void plan();
+    void end_planning();
+
+    // Hands an edit that was just made to the auto saver
+    void record(MealEdit edit);
+
     void reset_ids();
     void next_column(auto&& func);
-    void recalculate_total();
 
 private:
     int m_next_id = 0;
-    std::vector<Food> m_rows;
-    Food m_total_row{ .name = "Total" };
+    MealTable m_table;
 
     std::string m_title;
     std::string m_notes;
 
-    ImGui::ComboAutoSelectData m_dropdown_data{ std::vector<std::string>{} };
-    std::shared_ptr<food_values_table_type> m_food_values_table;
+    MealPlanner m_planner;
+    std::optional<MealPlanner::Targets> m_planner_targets;
+    std::vector<std::pair<float, float>> m_planner_bounds; // The weights that the planner may pick for every row
+    MealPlanner::Result m_planner_result;
+
+    ImGui::ComboAutoSelectData m_dropdown_data{ std::make_shared<const ImGui::ComboAutoSelectItems>() };
+    std::shared_ptr<const FoodCatalog> m_food_catalog;
+    std::shared_ptr<AutoSaver> m_auto_saver;
 };
 
+// Graph of a nutrient's daily totals over the whole history. The wheel zooms around the mouse, dragging pans.
+//
+// Every nutrient's series gets decimated into a `LodSeries` when the history changes, so drawing costs as much as the
+// width of the graph whatever the range shown.
+class HistoryGraphWidget {
+public:
+    HistoryGraphWidget() = default;
+    explicit HistoryGraphWidget(const std::shared_ptr<const HistoryStore>& history);
+
+    void draw();
+
+private:
+    void reload();
+    void draw_graph(const LodSeries& series);
+
+private:
+    std::shared_ptr<const HistoryStore> m_history;
+    std::optional<uint64_t> m_loaded_revision;
+    HistoryTotals m_totals;
+
+    // Sample `i` of a series is the sum of the meals eaten on `m_first_day + i`
+    std::chrono::sys_days m_first_day = {};
+    std::array<LodSeries, MealTable::column_count> m_series;
+    int m_column = Food::Calories;
+
+    // Visible range, in days since `m_first_day`
+    double m_view_first = 0.0;
+    double m_view_last  = 0.0;
+};
+
+// The window shows up right away, while the catalog, the history and today's meal load on a worker thread. Until they
+// are loaded, the windows only show that they are loading.
 class NutritionTracker : public Application {
 public:
     NutritionTracker();
 
 private:
+    // Everything that has to be loaded before the meal can be edited
+    struct LoadedState {
+        std::shared_ptr<const FoodCatalog> food_catalog;
+        std::shared_ptr<const ImGui::ComboAutoSelectItems> food_names;
+        std::shared_ptr<HistoryStore> history;
+        RecoveredMeal recovered;
+    };
+
+    [[nodiscard]] static LoadedState load();
+    void finish_loading(LoadedState loaded);
+    void draw_loading() const;
+
     void on_update(double dt) override;
 
 private:
+    std::future<LoadedState> m_loading;
+    clock::time_point m_loading_start_time;
+
     EditMealWidget m_edit_meal_widget;
-    std::shared_ptr<food_values_table_type> m_food_values_table = std::make_shared<food_values_table_type>();
+    HistoryGraphWidget m_history_graph_widget;
+    ProfilerWindow m_profiler_window;
+    MemoryWindow m_memory_window;
+    std::shared_ptr<const FoodCatalog> m_food_catalog;
+    std::shared_ptr<const ImGui::ComboAutoSelectItems> m_food_names;
+    std::shared_ptr<HistoryStore> m_history;
+    std::shared_ptr<AutoSaver> m_auto_saver;
 };
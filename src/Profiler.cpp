@@ -0,0 +1,182 @@
+#include "Profiler.h"
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <iterator>
+#include <fmt/format.h>
+#include "AtomicFile.h"
+
+
+namespace profiler {
+namespace {
+
+// Single producer, single consumer ring of the zones finished by one thread. The producer never waits: when the ring
+// is full, the zone gets dropped and counted.
+class ZoneRing {
+public:
+    static constexpr size_t capacity = size_t{ 1 } << 16;
+
+    bool push(const Zone& zone) noexcept {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == capacity) {
+            return false;
+        }
+
+        m_zones[head % capacity] = zone;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void drain(std::vector<Zone>& zones) {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto head = m_head.load(std::memory_order_acquire);
+        for (auto index = tail; index != head; ++index) {
+            zones.push_back(m_zones[index % capacity]);
+        }
+        m_tail.store(head, std::memory_order_release);
+    }
+
+private:
+    // Kept apart, so the producer and the consumer don't keep invalidating each other's cache line
+    alignas(64) std::atomic<uint64_t> m_head = 0;
+    alignas(64) std::atomic<uint64_t> m_tail = 0;
+    std::array<Zone, capacity> m_zones;
+};
+
+struct ThreadLog {
+    uint32_t index = 0;
+    std::string name;
+    ZoneRing ring;
+};
+
+// Logs outlive their threads, so that the zones of a thread that exited can still be collected
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadLog>> threads;
+    std::atomic<uint64_t> dropped_zones  = 0;
+    std::atomic<uint64_t> names_revision = 0;
+};
+
+// Taken during static initialization, before any zone could begin
+const auto g_start_time = now();
+
+Registry& registry() {
+    static auto instance = Registry{};
+    return instance;
+}
+
+ThreadLog& thread_log() {
+    thread_local auto* const log = [] {
+        auto& instance  = registry();
+        const auto lock = std::scoped_lock{ instance.mutex };
+
+        const auto index = static_cast<uint32_t>(instance.threads.size());
+        auto& added      = instance.threads.emplace_back(std::make_unique<ThreadLog>());
+        added->index     = index;
+        added->name      = fmt::format("Thread {}", index);
+        instance.names_revision.fetch_add(1, std::memory_order_relaxed);
+        return added.get();
+    }();
+    return *log;
+}
+
+void append_escaped(std::string& out, const std::string_view text) {
+    for (const auto character : text) {
+        if (character == '"' || character == '\\') {
+            out += '\\';
+            out += character;
+        } else if (static_cast<unsigned char>(character) < 0x20) {
+            fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(character));
+        } else {
+            out += character;
+        }
+    }
+}
+
+} // namespace
+
+
+int64_t start_time() noexcept {
+    return g_start_time;
+}
+
+void set_thread_name(std::string name) {
+    auto& log       = thread_log();
+    const auto lock = std::scoped_lock{ registry().mutex };
+    log.name        = std::move(name);
+    registry().names_revision.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<std::string> thread_names() {
+    auto& instance  = registry();
+    const auto lock = std::scoped_lock{ instance.mutex };
+
+    auto names = std::vector<std::string>{};
+    names.reserve(instance.threads.size());
+    for (const auto& thread : instance.threads) {
+        names.push_back(thread->name);
+    }
+    return names;
+}
+
+uint64_t thread_names_revision() noexcept {
+    return registry().names_revision.load(std::memory_order_relaxed);
+}
+
+void collect(std::vector<Zone>& zones) {
+    auto& instance  = registry();
+    const auto lock = std::scoped_lock{ instance.mutex };
+    for (const auto& thread : instance.threads) {
+        thread->ring.drain(zones);
+    }
+}
+
+uint64_t dropped_zone_count() noexcept {
+    return registry().dropped_zones.load(std::memory_order_relaxed);
+}
+
+void record(const Zone& zone) noexcept {
+    auto& log       = thread_log();
+    auto recorded   = zone;
+    recorded.thread = log.index;
+
+    if (!log.ring.push(recorded)) {
+        registry().dropped_zones.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::string to_chrome_trace(const std::span<const Zone> zones) {
+    auto out = std::string{ R"({"displayTimeUnit":"ms","traceEvents":[)" };
+
+    // Thread names are metadata events, zones are complete events with their timestamps in microseconds
+    const auto names  = thread_names();
+    const auto origin = start_time();
+    for (size_t index = 0; index < names.size(); ++index) {
+        fmt::format_to(std::back_inserter(out), R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":")",
+            index);
+        append_escaped(out, names[index]);
+        out += "\"}},";
+    }
+
+    for (const auto& zone : zones) {
+        out += R"({"name":")";
+        append_escaped(out, zone.name);
+        fmt::format_to(std::back_inserter(out), R"(","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}},)",
+            zone.thread, static_cast<double>(zone.begin - origin) / 1000.0,
+            static_cast<double>(zone.end - zone.begin) / 1000.0);
+    }
+
+    if (out.back() == ',') {
+        out.pop_back();
+    }
+    out += "]}";
+    return out;
+}
+
+bool write_chrome_trace(const std::filesystem::path& path, const std::span<const Zone> zones) {
+    return atomic_write_file(path, to_chrome_trace(zones));
+}
+
+} // namespace profiler
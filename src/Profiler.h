@@ -0,0 +1,107 @@
+#pragma once
+#include <span>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+
+// Scoped zones measure the time spent in a block of code:
+//
+//     void EditMealWidget::draw_table() {
+//         PROFILE_FUNCTION();
+//         ...
+//         {
+//             PROFILE_ZONE("Rows");
+//             ...
+//         }
+//     }
+//
+// Zones only exist in builds with `NT_ENABLE_PROFILER` defined, otherwise the macros expand to nothing. A zone reads
+// the clock twice and appends to a ring buffer owned by its thread, there are no locks and no allocations involved.
+#ifdef NT_ENABLE_PROFILER
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) const auto PROFILE_CONCAT(profile_zone_, __LINE__) = profiler::ScopedZone{ name }
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#define PROFILE_THREAD(name) profiler::set_thread_name(name)
+#else
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#define PROFILE_FUNCTION() static_cast<void>(0)
+#define PROFILE_THREAD(name) static_cast<void>(0)
+#endif
+
+
+namespace profiler {
+
+constexpr bool is_enabled =
+#ifdef NT_ENABLE_PROFILER
+    true;
+#else
+    false;
+#endif
+
+// `name` has to outlive the profiler, which string literals and `__func__` do
+struct Zone {
+    const char* name = "";
+    int64_t begin    = 0; // Nanoseconds of `now()`
+    int64_t end      = 0;
+    uint32_t thread  = 0; // Index into `thread_names()`
+    uint32_t depth   = 0; // Zones open on the same thread when this one began
+};
+
+// Steady clock time in nanoseconds, read directly so that zones cost as little as possible
+[[nodiscard]] inline int64_t now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// `now()` when the profiler started, the origin of exported traces
+[[nodiscard]] int64_t start_time() noexcept;
+
+// Names the calling thread in the timeline and in exported traces
+void set_thread_name(std::string name);
+[[nodiscard]] std::vector<std::string> thread_names();
+
+// Changes whenever a thread gets named or registered, so that the names only need to be copied again when it does
+[[nodiscard]] uint64_t thread_names_revision() noexcept;
+
+// Moves the zones that every thread finished since the last call to the end of `zones`. Only one thread may collect.
+void collect(std::vector<Zone>& zones);
+
+// Zones that got lost because their thread's buffer was full, since nobody collected for too long
+[[nodiscard]] uint64_t dropped_zone_count() noexcept;
+
+// Chrome's trace event format, as read by chrome://tracing and https://ui.perfetto.dev
+[[nodiscard]] std::string to_chrome_trace(std::span<const Zone> zones);
+bool write_chrome_trace(const std::filesystem::path& path, std::span<const Zone> zones);
+
+void record(const Zone& zone) noexcept;
+
+// Zones open on the calling thread
+inline thread_local uint32_t t_depth = 0;
+
+class ScopedZone {
+public:
+    explicit ScopedZone(const char* name) noexcept
+        : m_name(name)
+        , m_depth(t_depth++)
+        , m_begin(now()) {}
+
+    ~ScopedZone() {
+        const auto end = now();
+        --t_depth;
+        record({ .name = m_name, .begin = m_begin, .end = end, .thread = 0, .depth = m_depth });
+    }
+
+    ScopedZone(const ScopedZone&)            = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+    const char* m_name;
+    uint32_t m_depth;
+    int64_t m_begin;
+};
+
+} // namespace profiler
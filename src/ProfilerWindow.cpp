@@ -0,0 +1,166 @@
+#include "ProfilerWindow.h"
+
+#include <algorithm>
+#include <string_view>
+#include <functional>
+#include <fmt/format.h>
+#include <fmt/std.h>
+#include "imgui.h"
+#include "Application.h"
+
+
+namespace {
+
+// Older zones get dropped, so that the window's memory stays bounded however long the app runs
+constexpr auto retention = int64_t{ 5'000'000'000 };
+
+constexpr auto nanoseconds_per_ms = 1'000'000.0;
+
+// Every zone name keeps the same color from frame to frame
+ImU32 zone_color(const char* name) {
+    const auto hash = std::hash<std::string_view>{}(name);
+    const auto hue  = static_cast<float>(hash % 360) / 360.0f;
+
+    auto color = ImVec4{ 0.0f, 0.0f, 0.0f, 1.0f };
+    ImGui::ColorConvertHSVtoRGB(hue, 0.45f, 0.75f, color.x, color.y, color.z);
+    return ImGui::GetColorU32(color);
+}
+
+} // namespace
+
+
+void ProfilerWindow::draw() {
+    if constexpr (!profiler::is_enabled) {
+        ImGui::TextUnformatted("The profiler is compiled out, configure with -DNT_ENABLE_PROFILER=ON to enable it");
+        return;
+    }
+
+    if (!m_is_paused) {
+        collect();
+        m_view_end = m_latest_end;
+    }
+
+    ImGui::Checkbox("Pause", &m_is_paused);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("a").x * 20);
+    ImGui::SliderFloat("Span", &m_span_ms, 1.0f, 5'000.0f, "%.0f ms", ImGuiSliderFlags_Logarithmic);
+    ImGui::SameLine();
+
+    if (ImGui::Button("Export Chrome trace")) {
+        const auto path = std::filesystem::path{ "profile_trace.json" };
+        if (profiler::write_chrome_trace(path, m_zones)) {
+            m_status = fmt::format("Wrote {} zones to {}", m_zones.size(), path);
+        } else {
+            m_status = fmt::format("Failed to write {}", path);
+        }
+    }
+    if (!m_status.empty()) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(m_status.c_str());
+    }
+
+    if (const auto dropped = profiler::dropped_zone_count(); dropped != 0) {
+        ImGui::TextColored(
+            ImVec4{ 1.0f, 0.8f, 0.0f, 1.0f }, "%llu zones were dropped", static_cast<unsigned long long>(dropped));
+    }
+
+    const auto span = static_cast<int64_t>(static_cast<double>(m_span_ms) * nanoseconds_per_ms);
+    draw_timeline(m_view_end - span, m_view_end);
+}
+
+void ProfilerWindow::collect() {
+    const auto first_new = m_zones.size();
+    profiler::collect(m_zones);
+
+    // Copying the names every frame would allocate every frame
+    if (const auto revision = profiler::thread_names_revision(); revision != m_thread_names_revision) {
+        m_thread_names_revision = revision;
+        m_thread_names          = profiler::thread_names();
+    }
+
+    for (auto index = first_new; index < m_zones.size(); ++index) {
+        m_latest_end = std::max(m_latest_end, m_zones[index].end);
+    }
+
+    const auto cutoff = m_latest_end - retention;
+    std::erase_if(m_zones, [&](const profiler::Zone& zone) { return zone.end < cutoff; });
+}
+
+void ProfilerWindow::draw_timeline(const int64_t view_begin, const int64_t view_end) {
+    const auto is_visible = [&](const profiler::Zone& zone) { return zone.end >= view_begin && zone.begin <= view_end; };
+
+    // Every lane is as deep as the deepest zone visible on its thread
+    auto& arena      = Application::frame_arena();
+    auto lane_depths = std::pmr::vector<uint32_t>(m_thread_names.size(), 0, &arena);
+    for (const auto& zone : m_zones) {
+        if (is_visible(zone) && zone.thread < lane_depths.size()) {
+            lane_depths[zone.thread] = std::max(lane_depths[zone.thread], zone.depth + 1);
+        }
+    }
+
+    const auto row_height = ImGui::GetTextLineHeight() + 4.0f;
+    auto lane_tops        = std::pmr::vector<float>{ &arena };
+    auto height           = 0.0f;
+    for (const auto depth : lane_depths) {
+        lane_tops.push_back(height);
+        height += row_height * static_cast<float>(depth + 1);
+    }
+
+    const auto width  = ImGui::GetContentRegionAvail().x;
+    const auto origin = ImGui::GetCursorScreenPos();
+    if (width < 1.0f || height <= 0.0f) {
+        return;
+    }
+    ImGui::InvisibleButton("##timeline", ImVec2{ width, height });
+
+    const auto& io        = ImGui::GetIO();
+    const auto span       = static_cast<double>(view_end - view_begin);
+    const auto is_hovered = ImGui::IsItemHovered();
+    if (m_is_paused && ImGui::IsItemActive()) {
+        m_view_end -= static_cast<int64_t>(static_cast<double>(io.MouseDelta.x / width) * span);
+    }
+
+    const auto to_x = [&](const int64_t time) {
+        return origin.x + static_cast<float>(static_cast<double>(time - view_begin) / span) * width;
+    };
+
+    auto* draw_list = ImGui::GetWindowDrawList();
+    const auto end  = ImVec2{ origin.x + width, origin.y + height };
+    draw_list->PushClipRect(origin, end, true);
+
+    for (size_t thread = 0; thread < lane_depths.size(); ++thread) {
+        const auto top = origin.y + lane_tops[thread];
+        draw_list->AddRectFilled(ImVec2{ origin.x, top }, ImVec2{ end.x, top + row_height },
+            ImGui::GetColorU32(ImGuiCol_FrameBg));
+        draw_list->AddText(ImVec2{ origin.x + 4.0f, top + 2.0f }, ImGui::GetColorU32(ImGuiCol_Text),
+            m_thread_names[thread].c_str());
+    }
+
+    const profiler::Zone* hovered = nullptr;
+    for (const auto& zone : m_zones) {
+        if (!is_visible(zone) || zone.thread >= lane_depths.size()) {
+            continue;
+        }
+
+        // Zones shorter than a pixel still get drawn one pixel wide, so that they don't just vanish
+        const auto top = origin.y + lane_tops[zone.thread] + row_height * static_cast<float>(zone.depth + 1);
+        const auto min = ImVec2{ to_x(zone.begin), top };
+        const auto max = ImVec2{ std::max(to_x(zone.end), min.x + 1.0f), top + row_height - 1.0f };
+        draw_list->AddRectFilled(min, max, zone_color(zone.name));
+
+        const auto text_width = ImGui::CalcTextSize(zone.name).x;
+        if (max.x - min.x > text_width + 8.0f) {
+            draw_list->AddText(ImVec2{ min.x + 4.0f, min.y + 2.0f }, IM_COL32_BLACK, zone.name);
+        }
+
+        if (is_hovered && ImGui::IsMouseHoveringRect(min, max)) {
+            hovered = &zone;
+        }
+    }
+    draw_list->PopClipRect();
+
+    if (hovered != nullptr) {
+        ImGui::SetTooltip("%s\n%.3f ms", hovered->name,
+            static_cast<double>(hovered->end - hovered->begin) / nanoseconds_per_ms);
+    }
+}
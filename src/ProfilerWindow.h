@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Profiler.h"
+
+
+// Timeline of the zones recorded by every thread, one lane per thread and one row per nesting depth. It keeps the last
+// few seconds of zones, which can be exported as a Chrome trace.
+class ProfilerWindow {
+public:
+    void draw();
+
+private:
+    void collect();
+    void draw_timeline(int64_t view_begin, int64_t view_end);
+
+private:
+    std::vector<profiler::Zone> m_zones;
+    std::vector<std::string> m_thread_names;
+    uint64_t m_thread_names_revision = 0;
+    int64_t m_latest_end = 0;
+
+    // The view ends at the latest zone, until paused. A paused timeline can be dragged around.
+    bool m_is_paused   = false;
+    int64_t m_view_end = 0;
+    float m_span_ms    = 100.0f;
+
+    std::string m_status;
+};
@@ -0,0 +1,53 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include "Profiler.h"
+
+
+ThreadPool::ThreadPool(const size_t thread_count, std::string name)
+    : m_name(std::move(name)) {
+    const auto count = thread_count > 0 ? thread_count : std::max(std::thread::hardware_concurrency(), 1u);
+    m_threads.reserve(count);
+    for (size_t index = 0; index < count; ++index) {
+        m_threads.emplace_back([this, index] { run_worker(index); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const auto lock = std::scoped_lock{ m_mutex };
+        m_stop          = true;
+    }
+    m_task_queued.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    {
+        const auto lock = std::scoped_lock{ m_mutex };
+        m_tasks.push_back(std::move(task));
+    }
+    m_task_queued.notify_one();
+}
+
+void ThreadPool::run_worker([[maybe_unused]] const size_t index) {
+    PROFILE_THREAD(fmt::format("{} {}", m_name, index));
+
+    auto lock = std::unique_lock{ m_mutex };
+    while (true) {
+        m_task_queued.wait(lock, [&] { return m_stop || !m_tasks.empty(); });
+        if (m_tasks.empty()) {
+            return;
+        }
+
+        auto task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
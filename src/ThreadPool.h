@@ -0,0 +1,50 @@
+#pragma once
+#include <mutex>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+
+// Fixed set of worker threads that run submitted tasks in submission order. Destroying the pool finishes the tasks
+// that are already queued before joining the workers.
+class ThreadPool {
+public:
+    // `thread_count` 0 uses one thread per hardware thread. `name` names the workers in the profiler.
+    explicit ThreadPool(size_t thread_count = 0, std::string name = "Worker");
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] size_t thread_count() const noexcept {
+        return m_threads.size();
+    }
+
+    template <typename F>
+    [[nodiscard]] std::future<std::invoke_result_t<F>> submit(F task) {
+        // `std::function` needs a copyable target, which `std::packaged_task` isn't
+        auto packaged = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::move(task));
+        auto future   = packaged->get_future();
+        push([packaged = std::move(packaged)] { (*packaged)(); });
+        return future;
+    }
+
+private:
+    void push(std::function<void()> task);
+    void run_worker(size_t index);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_task_queued;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stop = false;
+
+    std::string m_name;
+    std::vector<std::thread> m_threads;
+};
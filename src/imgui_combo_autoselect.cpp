@@ -1,5 +1,7 @@
 #include "imgui_combo_autoselect.h"
 
+#include "Profiler.h"
+
 /*
  // Demo:
 	static ImGui::ComboAutoSelectData data = {{
@@ -38,41 +40,15 @@
 	ImGui::Text("Selection: %s, index = %d", data.input, data.index);
 */
 
-#ifdef _MSC_VER
-#    include <Shlwapi.h>
-#    define istrstr StrStrIA
-#    pragma comment(lib, "Shlwapi.lib")
-#else
-#    define istrstr strcasestr
-#endif
-
 namespace ImGui {
 bool ComboAutoSelectComplex(const char* label, char* buffer, int bufferlen, int* current_item,
-    bool (*items_getter)(void*, int, const char**), void* data, int items_count, ImGuiComboFlags flags);
-}
-
-static int fuzzy_search(const char* needle, void* data) {
-    auto& items = *reinterpret_cast<std::vector<std::string>*>(data);
-    for (int i = 0; i < static_cast<int>(items.size()); i++) {
-        auto haystack = items[static_cast<size_t>(i)].c_str();
-        // empty
-        if (!needle[0]) {
-            if (!haystack[0])
-                return i;
-            continue;
-        }
-        // exact match
-        if (strstr(haystack, needle))
-            return i;
-        // fuzzy match
-        if (istrstr(haystack, needle))
-            return i;
-    }
-    return -1;
+    bool (*items_getter)(void*, int, const char**), int (*items_search)(void*, const char*, const int**), void* data,
+    ImGuiComboFlags flags);
 }
 
 bool ImGui::ComboAutoSelectComplex(const char* label, char* input, int inputlen, int* current_item,
-    bool (*items_getter)(void*, int, const char**), void* data, int items_count, ImGuiComboFlags flags) {
+    bool (*items_getter)(void*, int, const char**), int (*items_search)(void*, const char*, const int**), void* data,
+    ImGuiComboFlags flags) {
     // Always consume the SetNextWindowSizeConstraint() call in our early return paths
     ImGuiContext& g = *GImGui;
 
@@ -194,6 +170,7 @@ bool ImGui::ComboAutoSelectComplex(const char* label, char* input, int inputlen,
 
     bool done = InputTextEx("##inputText", NULL, input, inputlen, ImVec2(0, 0),
         ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_EnterReturnsTrue, NULL, NULL);
+    bool inputEdited = IsItemEdited();
     PopItemWidth();
 
     if (!ret) {
@@ -208,90 +185,108 @@ bool ImGui::ComboAutoSelectComplex(const char* label, char* input, int inputlen,
         ImGuiWindowFlags_NoNavInputs | ImGuiWindowFlags_NoNavFocus; // 0; //ImGuiWindowFlags_HorizontalScrollbar
     BeginChild("ChildL", ImVec2(GetContentRegionAvail().x, GetContentRegionAvail().y), false, window_flags2);
 
+    // Only the ranked matches of the input are listed, best match first. `currentMatch` is the position of the
+    // selected item inside of that list, while `current_item` stays an index into the whole item list.
+    const int* matches      = NULL;
+    const int matches_count = items_search(data, input, &matches);
+
+    int currentMatch = -1;
+    for (int n = 0; n < matches_count; n++) {
+        if (matches[n] == *current_item) {
+            currentMatch = n;
+            break;
+        }
+    }
+
+    // Typing moves the selection back to the best match
     bool selectionChanged = false;
-    if (input[0] != '\0') {
-        int new_idx      = fuzzy_search(input, data);
-        int idx          = new_idx >= 0 ? new_idx : *current_item;
+    if (input[0] != '\0' && (inputEdited || currentMatch < 0)) {
+        currentMatch     = matches_count > 0 ? 0 : -1;
+        int idx          = currentMatch >= 0 ? matches[currentMatch] : *current_item;
         selectionChanged = *current_item != idx;
         *current_item    = idx;
     }
 
+    // The arrow keys move through the matches without touching the input, so that the list doesn't get filtered
+    // down to the highlighted item and the user can keep on typing afterwards
     bool arrowScroll = false;
-    // int arrowScrollIdx = *current_item;
 
     if (IsKeyPressed(GetKeyIndex(ImGuiKey_UpArrow))) {
-        if (*current_item > 0) {
-            *current_item -= 1;
+        if (currentMatch > 0) {
+            currentMatch -= 1;
             arrowScroll = true;
-            SetWindowFocus();
         }
     }
     if (IsKeyPressed(GetKeyIndex(ImGuiKey_DownArrow))) {
-        if (*current_item >= -1 && *current_item < items_count - 1) {
-            *current_item += 1;
+        if (currentMatch < matches_count - 1) {
+            currentMatch += 1;
             arrowScroll = true;
-            SetWindowFocus();
         }
     }
+    if (arrowScroll) {
+        *current_item = matches[currentMatch];
+    }
 
-    // select the first match
+    // select the highlighted match, or the best one if nothing is highlighted
     if (IsKeyPressed(GetKeyIndex(ImGuiKey_Enter))) {
-        arrowScroll   = true;
-        *current_item = fuzzy_search(input, data);
-        if (*current_item < 0)
-            *input = 0;
-        CloseCurrentPopup();
-    }
+        if (currentMatch < 0 && matches_count > 0) {
+            currentMatch = 0;
+        }
 
-    if (IsKeyPressed(GetKeyIndex(ImGuiKey_Backspace))) {
-        *current_item    = fuzzy_search(input, data);
-        selectionChanged = true;
+        if (currentMatch >= 0) {
+            selectionChanged = *current_item != matches[currentMatch];
+            *current_item    = matches[currentMatch];
+
+            const char* select_value = NULL;
+            items_getter(data, *current_item, &select_value);
+            strncpy(input, select_value, static_cast<size_t>(inputlen));
+        } else {
+            *current_item = -1;
+            *input        = 0;
+        }
+        CloseCurrentPopup();
     }
 
-    if (done && !arrowScroll) {
+    if (done) {
         CloseCurrentPopup();
     }
 
     bool done2 = false;
 
-    for (int n = 0; n < items_count; n++) {
-        bool is_selected = n == *current_item;
-        if (is_selected && (IsWindowAppearing() || selectionChanged)) {
-            SetScrollHereY();
-        }
-
-        if (is_selected && arrowScroll) {
-            SetScrollHereY();
-        }
+    // Only the visible rows get submitted, so the cost of a frame doesn't depend on the number of matches. The
+    // selected row is always included when it has to be scrolled to, since SetScrollHereY() needs it to be submitted.
+    const bool scrollToSelection = IsWindowAppearing() || selectionChanged || arrowScroll;
 
-        const char* select_value = NULL;
-        items_getter(data, n, &select_value);
-
-        // allow empty item
-        char item_id[128];
-        ImFormatString(item_id, sizeof(item_id), "%s##item_%02d", select_value, n);
-        if (Selectable(item_id, is_selected)) {
-            selectionChanged = *current_item != n;
-            *current_item    = n;
-            strncpy(input, select_value, static_cast<size_t>(inputlen));
-            CloseCurrentPopup();
-            done2 = true;
-        }
+    ImGuiListClipper clipper;
+    clipper.Begin(matches_count);
+    if (scrollToSelection && currentMatch >= 0) {
+        clipper.ForceDisplayRangeByIndices(currentMatch, currentMatch + 1);
     }
 
-    if (arrowScroll && *current_item > -1) {
-        const char* sActiveidxValue2 = NULL;
-        items_getter(data, *current_item, &sActiveidxValue2);
-        strncpy(input, sActiveidxValue2, static_cast<size_t>(inputlen));
-        ImGuiWindow* wnd           = FindWindowByName(name);
-        const ImGuiID id           = wnd->GetID("##inputText");
-        ImGuiInputTextState* state = GetInputTextState(id);
-
-        const char* buf_end = NULL;
-        state->CurLenW      = ImTextStrFromUtf8(state->TextW.Data, state->TextW.Size, input, NULL, &buf_end);
-        state->CurLenA      = static_cast<int>(buf_end - input);
-        state->CursorClamp();
+    while (clipper.Step()) {
+        for (int n = clipper.DisplayStart; n < clipper.DisplayEnd; n++) {
+            const int item   = matches[n];
+            bool is_selected = n == currentMatch;
+            if (is_selected && scrollToSelection) {
+                SetScrollHereY();
+            }
+
+            const char* select_value = NULL;
+            items_getter(data, item, &select_value);
+
+            // allow empty item
+            char item_id[128];
+            ImFormatString(item_id, sizeof(item_id), "%s##item_%02d", select_value, item);
+            if (Selectable(item_id, is_selected)) {
+                selectionChanged = *current_item != item;
+                *current_item    = item;
+                strncpy(input, select_value, static_cast<size_t>(inputlen));
+                CloseCurrentPopup();
+                done2 = true;
+            }
+        }
     }
+    clipper.End();
 
     EndChild();
     EndPopup();
@@ -305,16 +300,65 @@ bool ImGui::ComboAutoSelectComplex(const char* label, char* input, int inputlen,
     return widgetRet;
 }
 
-static bool vector_item_getter(void* data, int n, const char** out_str) {
-    auto& items = *static_cast<std::vector<std::string>*>(data);
+static std::vector<std::string_view> item_views(const ImGui::ComboAutoSelectItems& items) {
+    auto views = std::vector<std::string_view>{};
+    views.reserve(items.size());
+    for (size_t index = 0; index < items.size(); ++index) {
+        views.push_back(items.item(index));
+    }
+    return views;
+}
+
+ImGui::ComboAutoSelectItems::ComboAutoSelectItems()
+    : ComboAutoSelectItems(std::vector<std::string>{}) {}
+
+ImGui::ComboAutoSelectItems::ComboAutoSelectItems(
+    std::shared_ptr<const void> owner, const char* pool, const std::span<const uint32_t> offsets)
+    : m_owner(std::move(owner))
+    , m_pool(pool)
+    , m_offsets(offsets) {
+    m_search_index = FuzzySearchIndex{ item_views(*this) };
+}
+
+ImGui::ComboAutoSelectItems::ComboAutoSelectItems(const std::vector<std::string>& items) {
+    struct Pool {
+        std::string chars;
+        std::vector<uint32_t> offsets = { 0 };
+    };
+
+    auto pool = std::make_shared<Pool>();
+    for (const auto& item : items) {
+        pool->chars.append(item).push_back('\0');
+        pool->offsets.push_back(static_cast<uint32_t>(pool->chars.size()));
+    }
+
+    m_pool         = pool->chars.c_str();
+    m_offsets      = pool->offsets;
+    m_owner        = std::move(pool);
+    m_search_index = FuzzySearchIndex{ item_views(*this) };
+}
+
+static bool pool_item_getter(void* data, int n, const char** out_str) {
+    const auto& items = *static_cast<ImGui::ComboAutoSelectData*>(data)->items;
     if (n >= 0 && n < static_cast<int>(items.size())) {
-        *out_str = items[static_cast<size_t>(n)].c_str();
+        *out_str = items.c_item(static_cast<size_t>(n));
         return true;
     }
     return false;
 }
 
+static int index_search(void* data, const char* needle, const int** out_matches) {
+    PROFILE_ZONE("Combo search");
+
+    auto& combo_data   = *static_cast<ImGui::ComboAutoSelectData*>(data);
+    const auto& index  = combo_data.items->search_index();
+    const auto& result = combo_data.search_cache.search(index, needle, combo_data.max_results);
+
+    *out_matches = result.data();
+    return static_cast<int>(result.size());
+}
+
 bool ImGui::ComboAutoSelect(const char* label, ImGui::ComboAutoSelectData& data, ImGuiComboFlags flags) {
-    return ComboAutoSelectComplex(label, data.input, sizeof(data.input) - 1, &data.index, vector_item_getter,
-        static_cast<void*>(&data.items), static_cast<int>(data.items.size()), flags);
+    return ComboAutoSelectComplex(label, data.input, sizeof(data.input) - 1, &data.index, pool_item_getter, index_search,
+        static_cast<void*>(&data), flags);
 }
@@ -1,23 +1,75 @@
 #pragma once
 
+#include <span>
+#include <memory>
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <string_view>
 #include "imgui.h"
 #include "imgui_internal.h"
+#include "FuzzySearch.h"
 
 namespace ImGui {
+// The items listed by a combo, as a pool of null terminated strings: item `i` starts at `pool + offsets[i]` and its
+// terminator is at `pool + offsets[i + 1] - 1`. The pool isn't copied, `owner` only keeps it alive, so any number of
+// combos can share one pool (and one search index over it) with whoever else owns the strings.
+class ComboAutoSelectItems {
+public:
+    ComboAutoSelectItems();
+    ComboAutoSelectItems(std::shared_ptr<const void> owner, const char* pool, std::span<const uint32_t> offsets);
+
+    // Lays `items` out into a pool owned by the item source itself
+    explicit ComboAutoSelectItems(const std::vector<std::string>& items);
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_offsets.size() - 1;
+    }
+
+    [[nodiscard]] std::string_view item(const size_t index) const noexcept {
+        return { m_pool + m_offsets[index], m_offsets[index + 1] - m_offsets[index] - 1 };
+    }
+
+    [[nodiscard]] const char* c_item(const size_t index) const noexcept {
+        return m_pool + m_offsets[index];
+    }
+
+    [[nodiscard]] const FuzzySearchIndex& search_index() const noexcept {
+        return m_search_index;
+    }
+
+private:
+    std::shared_ptr<const void> m_owner;
+    const char* m_pool = "";
+    std::span<const uint32_t> m_offsets;
+    FuzzySearchIndex m_search_index;
+};
+
 struct ComboAutoSelectData {
-    std::vector<std::string> items;
+    std::shared_ptr<const ComboAutoSelectItems> items;
     int index       = -1;
     char input[128] = {};
 
-    ComboAutoSelectData(std::vector<std::string> hints, int selected_index = -1)
-        : items(std::move(hints)) {
-        if (selected_index > -1 && selected_index < static_cast<int>(items.size())) {
-            strncpy(input, items[static_cast<size_t>(selected_index)].c_str(), sizeof(input) - 1);
+    // Only the best `max_results` matches of the current input are listed in the popup
+    size_t max_results = 256;
+    FuzzySearchCache search_cache;
+
+    ComboAutoSelectData(std::shared_ptr<const ComboAutoSelectItems> shared_items, int selected_index = -1)
+        : items(std::move(shared_items)) {
+        if (selected_index > -1 && selected_index < static_cast<int>(items->size())) {
+            strncpy(input, items->c_item(static_cast<size_t>(selected_index)), sizeof(input) - 1);
             index = selected_index;
         }
     }
+
+    ComboAutoSelectData(const std::vector<std::string>& hints, int selected_index = -1)
+        : ComboAutoSelectData(std::make_shared<const ComboAutoSelectItems>(hints), selected_index) {}
+
+    void set_items(std::shared_ptr<const ComboAutoSelectItems> shared_items) {
+        items = std::move(shared_items);
+        search_cache.invalidate();
+        index = -1;
+    }
 };
 
 bool ComboAutoSelect(const char* label, ComboAutoSelectData& data, ImGuiComboFlags flags = 0);
@@ -0,0 +1,104 @@
+#include <cmath>
+#include <vector>
+#include <memory_resource>
+#include "Food.h"
+#include "MealTable.h"
+#include "MealPlanner.h"
+#include "FoodCatalog.h"
+#include "FrameArena.h"
+#include "MemoryStats.h"
+#include "Test.h"
+
+
+// Whatever runs on every frame must stop touching the heap once it is warmed up. The limits only count allocations in
+// builds with `NT_ENABLE_ALLOCATION_TRACKING`, where the tests run with assertions on, so the first allocation too many
+// aborts the run.
+namespace {
+
+constexpr auto row_count = size_t{ 64 };
+
+MealTable make_table() {
+    auto table = MealTable{};
+    for (size_t row = 0; row < row_count; ++row) {
+        const auto weight = 50.0f + 25.0f * static_cast<float>(row % 7);
+        table.push_back({
+            .id     = FoodCatalog::id_at(row),
+            .values = { 0.1f * weight, 0.5f * weight, 0.05f * weight, 2.5f * weight, weight },
+        });
+    }
+    return table;
+}
+
+// The arena's share of an idle frame: a label per row, and the scratch arrays of the history graph and the planner
+void draw_frame(FrameArena& arena, const MealTable& table) {
+    auto points = std::pmr::vector<float>{ &arena };
+    points.reserve(table.size());
+    for (size_t row = 0; row < table.size(); ++row) {
+        points.push_back(table.column(Food::Weight)[row]);
+        CHECK(*arena.format("{:.1f}g##weight_{}", points.back(), row) != '\0');
+    }
+    arena.reset();
+}
+
+} // namespace
+
+
+TEST_CASE("allocations/idle_frame") {
+    const auto table = make_table();
+
+    // Starts too small, so that the first frame overflows and the arena has to grow
+    auto arena = FrameArena{ 256 };
+    draw_frame(arena, table);
+    draw_frame(arena, table);
+
+    const auto limit = memory::AllocationLimit{ "allocations/idle_frame", 0 };
+    for (size_t frame = 0; frame < 60; ++frame) {
+        draw_frame(arena, table);
+    }
+    CHECK(arena.high_water_mark() <= arena.capacity());
+}
+
+TEST_CASE("allocations/meal_table_edit") {
+    auto table = make_table();
+
+    // The first scale allocates the snapshot that the following ones scale from
+    table.begin_scale();
+    static_cast<void>(table.end_scale());
+    const auto calories = table.totals()[Food::Calories];
+
+    const auto limit = memory::AllocationLimit{ "allocations/meal_table_edit", 0 };
+    for (size_t row = 0; row < table.size(); ++row) {
+        auto food = table.row(row);
+        food.values[Food::Weight] += 1.0f;
+        table.set_row(row, food);
+    }
+
+    table.begin_scale();
+    table.scale_total(Food::Calories, 1.5 * calories);
+    CHECK(std::abs(table.end_scale() - 1.5f) < 1e-6f);
+    CHECK(std::abs(table.totals()[Food::Calories] - 1.5 * calories) < 1e-6 * calories);
+}
+
+// A planner that is warm, like while the targets get dragged, solves within the buffers of its last solve
+TEST_CASE("allocations/planner_solve") {
+    auto candidates = std::vector<MealPlanner::Candidate>{};
+    for (size_t index = 0; index < 8; ++index) {
+        const auto protein = 0.05f * static_cast<float>(index + 1);
+        const auto carbo   = 0.6f - protein;
+        candidates.push_back({
+            .props      = { protein, carbo, 0.05f, 4.0f * (protein + carbo) + 0.45f, 1.0f },
+            .weight     = 100.0f,
+            .max_weight = 500.0f,
+        });
+    }
+
+    auto planner = MealPlanner{ candidates };
+    auto targets = MealPlanner::Targets{ 80.0, 250.0, NAN, NAN };
+    CHECK(planner.solve(targets).converged);
+
+    const auto limit = memory::AllocationLimit{ "allocations/planner_solve", 0 };
+    for (size_t frame = 0; frame < 30; ++frame) {
+        targets[Food::Protein] += 0.5;
+        CHECK(planner.solve(targets).converged);
+    }
+}
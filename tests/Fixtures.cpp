@@ -0,0 +1,53 @@
+#include "Fixtures.h"
+
+#include <array>
+#include <string_view>
+
+using namespace std::literals;
+
+
+namespace fixtures {
+
+std::string food_name(const size_t index) {
+    constexpr auto names = std::array{ "Orez"sv, "Ton"sv, "Pâine"sv, "Iaurt"sv, "Căpșuni"sv, "Brânză de vaci"sv };
+    return index < names.size() ? std::string{ names[index] } : "Food " + std::to_string(index);
+}
+
+FoodProps food_props(const size_t index) {
+    const auto protein = 0.05f * static_cast<float>(index + 1);
+    return { .props = { protein, 0.4f, 0.1f, 4.0f * protein + 2.5f, 1.0f } };
+}
+
+FoodCatalog make_catalog(const size_t food_count) {
+    auto builder = FoodCatalogBuilder{};
+    builder.reserve(food_count);
+    for (size_t index = 0; index < food_count; ++index) {
+        builder.add(food_name(index), food_props(index));
+    }
+    return std::move(builder).build();
+}
+
+const FoodCatalog& catalog() {
+    static const auto food_catalog = make_catalog(6);
+    return food_catalog;
+}
+
+Food make_row(const FoodCatalog& food_catalog, const FoodId id, const float weight) {
+    auto row = Food{ .id = id };
+    for (size_t value = 0; value < row.values.size(); ++value) {
+        row.values[value] = food_catalog.props(id).get_value_from_weight(value, weight);
+    }
+    return row;
+}
+
+MealSnapshot make_meal(const size_t seed) {
+    auto meal = MealSnapshot{ .title = "Prânz", .notes = (seed % 5 == 0) ? "Prea sărat"s : ""s };
+    for (size_t row = 0; row < 1 + seed % 8; ++row) {
+        const auto id     = FoodCatalog::id_at((seed + row) % catalog().size());
+        const auto weight = 10.0f + static_cast<float>((seed * 37 + row * 11) % 400) / 3.0f;
+        meal.rows.push_back(make_row(catalog(), id, weight));
+    }
+    return meal;
+}
+
+} // namespace fixtures
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include "Food.h"
+#include "Meal.h"
+#include "FoodCatalog.h"
+
+
+// The foods and meals that the tests share. Everything is deterministic, so a failing test fails the same way again.
+namespace fixtures {
+
+// "Orez", "Ton", "Pâine", "Iaurt", "Căpșuni", "Brânză de vaci", then "Food 6", "Food 7" and so on
+[[nodiscard]] std::string food_name(size_t index);
+
+// The protein of the foods grows with their index, so that no two of them are alike
+[[nodiscard]] FoodProps food_props(size_t index);
+
+// The first `food_count` foods, in order
+[[nodiscard]] FoodCatalog make_catalog(size_t food_count);
+
+// The first 6 foods
+[[nodiscard]] const FoodCatalog& catalog();
+
+// The row of the food `id` of `food_catalog` weighing `weight`
+[[nodiscard]] Food make_row(const FoodCatalog& food_catalog, FoodId id, float weight);
+
+// A meal of up to 8 rows of `catalog()` that depends on `seed`, with weights that don't round to whole grams
+[[nodiscard]] MealSnapshot make_meal(size_t seed);
+
+} // namespace fixtures
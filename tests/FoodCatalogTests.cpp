@@ -0,0 +1,67 @@
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include "FoodCatalog.h"
+#include "Fixtures.h"
+#include "Test.h"
+
+
+namespace {
+
+using fixtures::make_catalog;
+
+bool has_foods(const FoodCatalog& food_catalog, const size_t food_count) {
+    for (size_t index = 0; index < food_count; ++index) {
+        const auto id      = food_catalog.find_id(fixtures::food_name(index));
+        const auto protein = fixtures::food_props(index).props[Food::Protein];
+        if (id != FoodCatalog::id_at(index) || food_catalog.props(*id).props[Food::Protein] != protein) {
+            return false;
+        }
+    }
+    return food_catalog.size() == food_count;
+}
+
+} // namespace
+
+
+// Writing replaces the file, so a catalog that is still mapped keeps reading the foods it was loaded with
+TEST_CASE("food_catalog/write_binary") {
+    const auto path   = std::filesystem::temp_directory_path() / "nutrition-tracker-tests-catalog.bin";
+    const auto source = FoodCatalogSource{ .size = 42, .last_write_time = 7 };
+    CHECK(make_catalog(100).write_binary(path, source));
+
+    const auto mapped = FoodCatalog::load_binary(path, source);
+    CHECK(mapped.has_value() && has_foods(*mapped, 100));
+
+    CHECK(make_catalog(1'000).write_binary(path, source));
+    const auto rewritten = FoodCatalog::load_binary(path, source);
+    CHECK(rewritten.has_value() && has_foods(*rewritten, 1'000));
+    CHECK(mapped.has_value() && has_foods(*mapped, 100));
+
+    // A catalog compiled from another database is stale
+    CHECK(!FoodCatalog::load_binary(path, FoodCatalogSource{ .size = 43, .last_write_time = 7 }).has_value());
+
+    auto error = std::error_code{};
+    std::filesystem::remove(path, error);
+}
+
+// A stale catalog gets parsed from the database once, and compiled again for the next launches
+TEST_CASE("food_catalog/load_rebuilds_binary") {
+    const auto directory   = std::filesystem::temp_directory_path();
+    const auto json_path   = directory / "nutrition-tracker-tests-database.json";
+    const auto binary_path = directory / "nutrition-tracker-tests-database.bin";
+    std::filesystem::remove(binary_path);
+    std::ofstream{ json_path, std::ios::binary | std::ios::trunc }
+        << R"({ "Orez": { "protein": 0.05, "carbo": 0.4, "fat": 0.1, "calories": 2.7 },
+                "Ton": { "protein": 0.1, "carbo": 0.4, "fat": 0.1, "calories": 2.9 } })";
+
+    const auto parsed = FoodCatalog::load(binary_path, json_path);
+    CHECK(parsed.has_value() && has_foods(*parsed, 2));
+
+    const auto compiled = FoodCatalog::load_binary(binary_path, FoodCatalogSource::of(json_path));
+    CHECK(compiled.has_value() && has_foods(*compiled, 2));
+
+    auto error = std::error_code{};
+    std::filesystem::remove(json_path, error);
+    std::filesystem::remove(binary_path, error);
+}
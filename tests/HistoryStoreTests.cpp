@@ -0,0 +1,159 @@
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include "Meal.h"
+#include "FoodCatalog.h"
+#include "HistoryStore.h"
+#include "Fixtures.h"
+#include "Test.h"
+
+
+namespace {
+
+using fixtures::catalog;
+
+constexpr auto june_day  = std::chrono::sys_days{ std::chrono::year{ 2024 } / 6 / 30 };
+constexpr auto july_day  = std::chrono::sys_days{ std::chrono::year{ 2024 } / 7 / 1 };
+constexpr auto both_days = std::pair{ june_day, july_day };
+
+// A meal of a single food, the totals only get checked by its weight
+MealSnapshot make_meal(const float weight) {
+    return { .title = "Prânz", .rows = { fixtures::make_row(catalog(), FoodCatalog::id_at(0), weight) } };
+}
+
+// A history of its own, deleted again at the end of the test
+class TemporaryDirectory {
+public:
+    explicit TemporaryDirectory(const std::string& name)
+        : m_path(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(m_path);
+    }
+
+    ~TemporaryDirectory() {
+        auto error = std::error_code{};
+        std::filesystem::remove_all(m_path, error);
+    }
+
+    TemporaryDirectory(const TemporaryDirectory&)            = delete;
+    TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+    [[nodiscard]] const std::filesystem::path& path() const noexcept {
+        return m_path;
+    }
+
+private:
+    std::filesystem::path m_path;
+};
+
+std::string read_file(const std::filesystem::path& path) {
+    auto contents = std::string(std::filesystem::file_size(path), '\0');
+    std::ifstream{ path, std::ios::binary }.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return contents;
+}
+
+} // namespace
+
+
+TEST_CASE("history_store/reopen") {
+    const auto directory = TemporaryDirectory{ "nutrition-tracker-tests-reopen" };
+    {
+        auto history = HistoryStore{ directory.path() };
+        CHECK(history.store_meal({ .day = june_day, .meal = 0 }, make_meal(100.0f), catalog()));
+        CHECK(history.store_meal({ .day = july_day, .meal = 0 }, make_meal(200.0f), catalog()));
+    }
+
+    const auto history = HistoryStore{ directory.path() };
+    CHECK(history.date_range() == both_days);
+    CHECK(history.range_totals(june_day, july_day).sums[Food::Weight] == 300.0);
+    CHECK(history.load_meal({ .day = july_day, .meal = 0 }, catalog()) == make_meal(200.0f));
+}
+
+// A save whose index failed to be written leaves the chunks newer than the index, or the index gone
+TEST_CASE("history_store/stale_index") {
+    const auto directory  = TemporaryDirectory{ "nutrition-tracker-tests-stale-index" };
+    const auto index_path = directory.path() / "index.bin";
+    auto old_index        = std::string{};
+    {
+        auto history = HistoryStore{ directory.path() };
+        CHECK(history.store_meal({ .day = june_day, .meal = 0 }, make_meal(100.0f), catalog()));
+        old_index = read_file(index_path);
+
+        CHECK(history.store_meal({ .day = june_day, .meal = 1 }, make_meal(50.0f), catalog()));
+        CHECK(history.store_meal({ .day = july_day, .meal = 0 }, make_meal(200.0f), catalog()));
+    }
+
+    std::ofstream{ index_path, std::ios::binary | std::ios::trunc } << old_index;
+    std::filesystem::last_write_time(index_path, std::filesystem::file_time_type::clock::now() - std::chrono::hours{ 1 });
+    {
+        const auto history = HistoryStore{ directory.path() };
+        CHECK(history.date_range() == both_days);
+        CHECK(history.range_totals(june_day, july_day).sums[Food::Weight] == 350.0);
+    }
+
+    std::filesystem::remove(index_path);
+    const auto history = HistoryStore{ directory.path() };
+    CHECK(history.date_range() == both_days);
+    CHECK(history.range_totals(june_day, july_day).sums[Food::Weight] == 350.0);
+}
+
+// Once its chunk is replaced a meal is stored, even when the index can't be written after it
+TEST_CASE("history_store/index_write_fails") {
+    const auto directory  = TemporaryDirectory{ "nutrition-tracker-tests-index-write-fails" };
+    const auto index_path = directory.path() / "index.bin";
+    const auto key        = MealKey{ .day = june_day, .meal = 0 };
+    {
+        auto history = HistoryStore{ directory.path() };
+        CHECK(history.range_totals(june_day, july_day).sums[Food::Weight] == 0.0);
+
+        // The index can't be replaced by a file while a directory is in its way
+        std::filesystem::create_directories(index_path / "in-the-way");
+        CHECK(history.store_meal(key, make_meal(100.0f), catalog()));
+        CHECK(history.store_meal(key, make_meal(150.0f), catalog()));
+        CHECK(history.store_meal(key, make_meal(150.0f), catalog()));
+
+        CHECK(history.revision() == 3);
+        const auto june_only = std::pair{ june_day, june_day };
+        CHECK(history.date_range() == june_only);
+        CHECK(history.range_totals(june_day, july_day).sums[Food::Weight] == 150.0);
+        CHECK(history.load_meal(key, catalog()) == make_meal(150.0f));
+    }
+
+    std::filesystem::remove_all(index_path);
+    const auto history = HistoryStore{ directory.path() };
+    CHECK(history.range_totals(june_day, july_day).sums[Food::Weight] == 150.0);
+    CHECK(history.load_meal(key, catalog()) == make_meal(150.0f));
+}
+
+// Queries run while meals get saved, and only ever see whole meals
+TEST_CASE("history_store/concurrent_saves") {
+    const auto directory = TemporaryDirectory{ "nutrition-tracker-tests-concurrent-saves" };
+    auto history         = HistoryStore{ directory.path() };
+
+    // The checks are not thread safe, the saves get counted instead
+    constexpr auto meal_count = uint32_t{ 20 };
+    auto stored_count         = std::atomic<uint32_t>{ 0 };
+    auto is_done              = std::atomic<bool>{ false };
+    auto saver                = std::thread{ [&] {
+        for (uint32_t meal = 0; meal < meal_count; ++meal) {
+            if (history.store_meal({ .day = june_day, .meal = meal }, make_meal(10.0f), catalog())) {
+                stored_count.fetch_add(1);
+            }
+        }
+        is_done.store(true);
+    } };
+
+    auto is_whole = true;
+    while (!is_done.load()) {
+        const auto weight = history.range_totals(june_day, july_day).sums[Food::Weight];
+        is_whole          = is_whole && weight == 10.0 * std::round(weight / 10.0);
+    }
+    saver.join();
+
+    CHECK(is_whole);
+    CHECK(stored_count.load() == meal_count);
+    CHECK(history.range_totals(june_day, july_day).sums[Food::Weight] == 10.0 * meal_count);
+}
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "MealDocument.h"
+#include "FoodCatalog.h"
+#include "Fixtures.h"
+#include "Test.h"
+
+
+namespace {
+
+using fixtures::catalog;
+using fixtures::make_meal;
+
+// Three meals a day for `day_count` days up to the end of 2024
+MealDocument make_history(const size_t day_count) {
+    const auto last_day = std::chrono::sys_days{ std::chrono::year{ 2024 } / 12 / 31 };
+
+    auto history = MealDocument{};
+    for (size_t day = 0; day < day_count; ++day) {
+        for (uint32_t index = 0; index < 3; ++index) {
+            history.meals.push_back({
+                .day   = last_day - std::chrono::days{ static_cast<int>(day_count - day - 1) },
+                .index = index,
+                .meal  = make_meal(day * 3 + index),
+            });
+        }
+    }
+    return history;
+}
+
+bool round_trips_binary(const MealDocument& document) {
+    return MealDocument::decode(document.encode(catalog()), catalog()) == document;
+}
+
+bool round_trips_json(const MealDocument& document) {
+    return MealDocument::from_json(nlohmann::json::parse(document.to_json(catalog()).dump()), catalog()) == document;
+}
+
+} // namespace
+
+
+TEST_CASE("meal_document/empty") {
+    CHECK(round_trips_binary(MealDocument{}));
+    CHECK(round_trips_json(MealDocument{}));
+}
+
+TEST_CASE("meal_document/meal_without_a_day") {
+    const auto document = MealDocument{ .meals = { { .index = 2, .meal = make_meal(7) } }, .journal_sequence = 42 };
+    CHECK(round_trips_binary(document));
+    CHECK(round_trips_json(document));
+}
+
+TEST_CASE("meal_document/history") {
+    const auto history = make_history(3'653);
+    CHECK(round_trips_binary(history));
+    CHECK(round_trips_json(history));
+
+    // Every food of the history gets its name written once
+    CHECK(history.encode(catalog()).size() < history.meals.size() * 200);
+}
+
+// Snapshots from before the binary format are a single meal with its day, index and sequence next to its rows
+TEST_CASE("meal_document/json_snapshot") {
+    const auto meal = make_meal(5);
+
+    auto snapshot                = meal.to_json(catalog());
+    snapshot["day"]              = "2024-06-30";
+    snapshot["meal"]             = 2;
+    snapshot["journal_sequence"] = 42;
+
+    const auto document = MealDocument::from_json(snapshot, catalog());
+    const auto day      = std::chrono::sys_days{ std::chrono::year{ 2024 } / 6 / 30 };
+    const auto expected = MealDocument{ .meals = { { .day = day, .index = 2, .meal = meal } }, .journal_sequence = 42 };
+    CHECK(document == expected);
+}
+
+TEST_CASE("meal_document/truncated") {
+    const auto bytes = make_history(3).encode(catalog());
+    for (size_t size = 0; size < bytes.size(); ++size) {
+        CHECK(!MealDocument::decode(std::string_view{ bytes }.substr(0, size), catalog()).has_value());
+    }
+
+    // Trailing bytes make it as invalid as missing ones
+    CHECK(!MealDocument::decode(bytes + '\0', catalog()).has_value());
+}
+
+TEST_CASE("meal_document/newer_schema") {
+    auto bytes         = make_history(3).encode(catalog());
+    const auto version = MealDocument::schema_version + 1;
+    std::memcpy(bytes.data() + sizeof(MealDocument::magic), &version, sizeof(version));
+    CHECK(!MealDocument::decode(bytes, catalog()).has_value());
+}
+
+// The rows of foods that are missing from the catalog the document is read with get skipped, the rest stays
+TEST_CASE("meal_document/unknown_foods") {
+    const auto smaller_catalog = fixtures::make_catalog(3);
+    const auto history         = make_history(30);
+    const auto document        = MealDocument::decode(history.encode(catalog()), smaller_catalog);
+
+    CHECK(document.has_value() && document->meals.size() == history.meals.size());
+    for (size_t index = 0; document.has_value() && index < history.meals.size(); ++index) {
+        auto expected = history.meals[index].meal;
+        std::erase_if(expected.rows, [&](const Food& row) { return !smaller_catalog.contains(row.id); });
+        CHECK(document->meals[index].meal.rows == expected.rows);
+    }
+}
@@ -0,0 +1,65 @@
+#include "Test.h"
+
+#include <vector>
+#include <fmt/format.h>
+#include <fmt/color.h>
+
+
+namespace test {
+namespace {
+
+struct Entry {
+    std::string_view name;
+    Function function = nullptr;
+};
+
+// Function local, since tests register themselves during static initialization
+std::vector<Entry>& entries() {
+    static auto registered = std::vector<Entry>{};
+    return registered;
+}
+
+size_t failed_checks = 0;
+
+} // namespace
+
+
+bool add(const std::string_view name, const Function function) {
+    entries().push_back({ .name = name, .function = function });
+    return true;
+}
+
+void check(const bool passed, const std::string_view expression, const std::source_location location) {
+    if (!passed) {
+        fmt::print(stderr, fmt::fg(fmt::color::red), "[ERROR]: {}:{}: CHECK({}) failed\n", location.file_name(),
+            location.line(), expression);
+        failed_checks += 1;
+    }
+}
+
+size_t run(const std::string_view filter) {
+    auto run_count    = size_t{ 0 };
+    auto failed_count = size_t{ 0 };
+
+    for (const auto& [name, function] : entries()) {
+        if (name.find(filter) == std::string_view::npos) {
+            continue;
+        }
+
+        failed_checks = 0;
+        function();
+        run_count += 1;
+
+        if (failed_checks != 0) {
+            fmt::print(stderr, fmt::fg(fmt::color::red), "[FAILED]: {}\n", name);
+            failed_count += 1;
+        } else {
+            fmt::print("[PASSED]: {}\n", name);
+        }
+    }
+
+    fmt::print("[INFO]: {} of {} tests passed\n", run_count - failed_count, run_count);
+    return failed_count;
+}
+
+} // namespace test
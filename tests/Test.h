@@ -0,0 +1,37 @@
+#pragma once
+#include <string_view>
+#include <source_location>
+
+
+// Minimal test harness. A test is a function registered under a name with `TEST_CASE`, and `CHECK` records a failure
+// without stopping the test, so that a single run reports everything that is wrong:
+//
+//     TEST_CASE("meal_document/empty") {
+//         CHECK(MealDocument::decode(MealDocument{}.encode(catalog), catalog) == MealDocument{});
+//     }
+//
+// Tests run in the order that they are registered in, every test file registers its own.
+namespace test {
+
+using Function = void (*)();
+
+// Returns true, so that registering can initialize a static
+bool add(std::string_view name, Function function);
+
+void check(bool passed, std::string_view expression, std::source_location location = std::source_location::current());
+
+// Runs every test whose name contains `filter` and prints the failed checks. Returns the number of failed tests.
+size_t run(std::string_view filter);
+
+} // namespace test
+
+
+#define TEST_CONCAT_IMPL(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_IMPL(a, b)
+#define TEST_CASE_IMPL(name, function)                                                                                \
+    static void function();                                                                                            \
+    [[maybe_unused]] static const bool TEST_CONCAT(function, _registered) = test::add(name, &function);               \
+    static void function()
+#define TEST_CASE(name) TEST_CASE_IMPL(name, TEST_CONCAT(test_case_, __LINE__))
+
+#define CHECK(expression) test::check(!!(expression), #expression)
@@ -0,0 +1,26 @@
+#include <span>
+#include <cstdlib>
+#include <string_view>
+#include <fmt/format.h>
+#include "MemoryStats.h"
+#include "Test.h"
+
+using namespace std::literals;
+
+
+// Usage: tests [filter]
+int main(int argc, char* argv[]) {
+    const auto args = std::span{ argv, static_cast<size_t>(argc) }.subspan(1);
+    if (args.size() > 1) {
+        fmt::print("Usage: tests [filter]\n");
+        return EXIT_FAILURE;
+    }
+
+    // Code under an `AllocationLimit` that allocates more than it may fails the run
+    memory::set_assertions(true);
+    if (!memory::is_enabled) {
+        fmt::print("[INFO]: Allocations aren't counted, configure with NT_ENABLE_ALLOCATION_TRACKING to check them\n");
+    }
+
+    return test::run(args.empty() ? ""sv : std::string_view{ args[0] }) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}